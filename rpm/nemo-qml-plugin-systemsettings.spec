@@ -16,6 +16,7 @@ Requires:       udisks2 >= 2.8.1+git6
 Requires:       mlite-qt5 >= 0.3.6
 Requires(post): coreutils
 BuildRequires:  pkgconfig(Qt5Qml)
+BuildRequires:  pkgconfig(Qt5Test)
 BuildRequires:  pkgconfig(Qt5XmlPatterns)
 BuildRequires:  pkgconfig(timed-qt5)
 BuildRequires:  pkgconfig(profile)
@@ -83,6 +84,7 @@ fi
 %{_libdir}/qt5/qml/org/nemomobile/systemsettings/qmldir
 %{_libdir}/libsystemsettings.so.*
 %attr(4710,-,privileged) %{_libexecdir}/setlocale
+%attr(4710,-,privileged) %{_libexecdir}/storagetrim
 %dir %attr(0775, root, privileged) /etc/location
 %config %attr(0664, root, privileged) /etc/location/location.conf
 %dir %attr(0775, root, privileged) /var/lib/location
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2026 Nemo Mobile Project
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include "bdi_p.h"
+#include "logging_p.h"
+
+#include <QFile>
+
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+
+namespace {
+
+// Parses "Key: value kB" lines as found in /proc/meminfo and the debugfs BDI stats.
+qint64 kiloBytesValue(const QByteArray &data, const QByteArray &key)
+{
+    for (const QByteArray &line : data.split('\n')) {
+        if (line.startsWith(key)) {
+            const QList<QByteArray> fields = line.mid(key.size()).simplified().split(' ');
+            bool ok = false;
+            const qint64 value = fields.value(0).toLongLong(&ok);
+            return ok ? value * 1024 : -1;
+        }
+    }
+    return -1;
+}
+
+QByteArray readFile(const QString &path)
+{
+    QFile file(path);
+    return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+}
+
+}
+
+QString Bdi::name(const QString &mountPath)
+{
+    struct stat st;
+    if (::stat(QFile::encodeName(mountPath).constData(), &st) != 0) {
+        return QString();
+    }
+    return QStringLiteral("%1:%2").arg(major(st.st_dev)).arg(minor(st.st_dev));
+}
+
+Bdi::WritebackState Bdi::writebackState(const QString &bdi)
+{
+    WritebackState state;
+
+    // Per device statistics are only in debugfs, which is usually readable by root only.
+    const QByteArray stats = bdi.isEmpty()
+            ? QByteArray()
+            : readFile(QStringLiteral("/sys/kernel/debug/bdi/") + bdi + QStringLiteral("/stats"));
+    if (!stats.isEmpty()) {
+        state.dirtyBytes = kiloBytesValue(stats, "BdiDirty:");
+        state.writebackBytes = kiloBytesValue(stats, "BdiWriteback:");
+        state.perDevice = state.dirtyBytes >= 0 && state.writebackBytes >= 0;
+    }
+
+    if (!state.perDevice) {
+        const QByteArray meminfo = readFile(QStringLiteral("/proc/meminfo"));
+        state.dirtyBytes = kiloBytesValue(meminfo, "Dirty:");
+        state.writebackBytes = kiloBytesValue(meminfo, "Writeback:");
+    }
+
+    return state;
+}
+
+QByteArray Bdi::readAttribute(const QString &bdi, const QString &attribute)
+{
+    return readFile(QStringLiteral("/sys/class/bdi/") + bdi + QLatin1Char('/') + attribute).trimmed();
+}
+
+bool Bdi::writeAttribute(const QString &bdi, const QString &attribute, const QByteArray &value)
+{
+    QFile file(QStringLiteral("/sys/class/bdi/") + bdi + QLatin1Char('/') + attribute);
+    if (!file.open(QIODevice::WriteOnly) || file.write(value) != value.size()) {
+        qCWarning(lcMemoryCardLog) << "Cannot write" << value << "to" << file.fileName() << file.errorString();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,407 @@
+/*
+ * Copyright (C) 2026 Nemo Mobile Project
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include "cacheusagemodel.h"
+#include "directorysize_p.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QSet>
+#include <QThread>
+#include <QVector>
+
+#include <algorithm>
+
+namespace {
+
+struct CacheUsageEntry
+{
+    QString application;
+    CacheUsageModel::CacheType type = CacheUsageModel::ApplicationCache;
+    QStringList paths;
+    quint64 bytes = 0;
+
+    QString key() const
+    {
+        return QString::number(type) + QLatin1Char(':') + application;
+    }
+};
+
+typedef QVector<CacheUsageEntry> CacheUsageEntryList;
+
+QString environmentPath(const char *variable, const QString &fallback)
+{
+    const QString path = QString::fromLocal8Bit(qgetenv(variable));
+    return path.isEmpty() ? fallback : path;
+}
+
+}
+
+Q_DECLARE_METATYPE(CacheUsageEntry)
+Q_DECLARE_METATYPE(CacheUsageEntryList)
+
+class CacheUsageWorker : public QObject
+{
+    Q_OBJECT
+public:
+    CacheUsageWorker() : m_quit(false) {}
+
+    void scheduleQuit() { m_quit = true; }
+
+public slots:
+    void calculate();
+    void purge(const CacheUsageEntryList &entries);
+
+signals:
+    void calculated(const CacheUsageEntryList &entries);
+    void purged(const CacheUsageEntry &entry, quint64 bytesFreed);
+
+private:
+    CacheUsageEntryList locate() const;
+
+    DirectorySizeCache m_sizes;
+    bool m_quit;
+};
+
+CacheUsageEntryList CacheUsageWorker::locate() const
+{
+    CacheUsageEntryList entries;
+    QHash<QString, int> applicationIndexes;
+
+    const QString home = QDir::homePath();
+
+    // XDG cache home is usually ~/.cache but may have been moved elsewhere, cover both.
+    QStringList cacheRoots;
+    cacheRoots << QFileInfo(environmentPath("XDG_CACHE_HOME", home + QStringLiteral("/.cache"))).canonicalFilePath();
+    cacheRoots << QFileInfo(home + QStringLiteral("/.cache")).canonicalFilePath();
+    cacheRoots.removeAll(QString());
+    cacheRoots.removeDuplicates();
+
+    for (const QString &root : cacheRoots) {
+        const QFileInfoList applications = QDir(root).entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot | QDir::Hidden);
+        for (const QFileInfo &application : applications) {
+            if (application.isSymLink()) {
+                continue;
+            }
+
+            const int index = applicationIndexes.value(application.fileName(), -1);
+            if (index >= 0) {
+                entries[index].paths.append(application.filePath());
+            } else {
+                CacheUsageEntry entry;
+                entry.application = application.fileName();
+                entry.type = CacheUsageModel::ApplicationCache;
+                entry.paths << application.filePath();
+                applicationIndexes.insert(entry.application, entries.count());
+                entries.append(entry);
+            }
+        }
+    }
+
+    // Older adaptations (e.g. Jolla 1) don't have /home/.android/. Android home is in the root.
+    const QString androidHome = QDir(QStringLiteral("/home/.android")).exists() ? QStringLiteral("/home/.android") : QString();
+    const QFileInfoList packages = QDir(androidHome + QStringLiteral("/data/data")).entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QFileInfo &package : packages) {
+        CacheUsageEntry entry;
+        entry.application = package.fileName();
+        entry.type = CacheUsageModel::AndroidApplicationCache;
+        for (const QString &cacheDirectory : { QStringLiteral("cache"), QStringLiteral("code_cache") }) {
+            const QString path = package.filePath() + QLatin1Char('/') + cacheDirectory;
+            if (QFileInfo(path).isDir()) {
+                entry.paths << path;
+            }
+        }
+        if (!entry.paths.isEmpty()) {
+            entries.append(entry);
+        }
+    }
+
+    CacheUsageEntry trash;
+    trash.type = CacheUsageModel::Trash;
+    const QString trashRoot = environmentPath("XDG_DATA_HOME", home + QStringLiteral("/.local/share")) + QStringLiteral("/Trash");
+    for (const QString &trashDirectory : { QStringLiteral("files"), QStringLiteral("info"), QStringLiteral("expunged") }) {
+        const QString path = trashRoot + QLatin1Char('/') + trashDirectory;
+        if (QFileInfo(path).isDir()) {
+            trash.paths << path;
+        }
+    }
+    if (!trash.paths.isEmpty()) {
+        entries.append(trash);
+    }
+
+    return entries;
+}
+
+void CacheUsageWorker::calculate()
+{
+    CacheUsageEntryList entries = locate();
+
+    for (auto it = entries.begin(); it != entries.end() && !m_quit; ++it) {
+        for (const QString &path : it->paths) {
+            it->bytes += m_sizes.size(path);
+        }
+    }
+
+    entries.erase(std::remove_if(entries.begin(), entries.end(), [](const CacheUsageEntry &entry) {
+        return entry.bytes == 0;
+    }), entries.end());
+
+    std::stable_sort(entries.begin(), entries.end(), [](const CacheUsageEntry &lhs, const CacheUsageEntry &rhs) {
+        return lhs.bytes > rhs.bytes;
+    });
+
+    emit calculated(entries);
+}
+
+void CacheUsageWorker::purge(const CacheUsageEntryList &entries)
+{
+    for (CacheUsageEntry entry : entries) {
+        if (m_quit) {
+            break;
+        }
+
+        quint64 bytesFreed = 0;
+        entry.bytes = 0;
+        for (const QString &path : entry.paths) {
+            bytesFreed += m_sizes.removeContents(path);
+            entry.bytes += m_sizes.size(path);
+        }
+
+        emit purged(entry, bytesFreed);
+    }
+}
+
+class CacheUsageModelPrivate : public QObject
+{
+    Q_OBJECT
+public:
+    CacheUsageModelPrivate(CacheUsageModel *model);
+    ~CacheUsageModelPrivate();
+
+    void setPendingRequests(int count);
+    qint64 totalBytes() const;
+
+    CacheUsageModel *q;
+    QThread *m_thread;
+    CacheUsageWorker *m_worker;
+    CacheUsageEntryList m_entries;
+    QSet<QString> m_purging;
+    int m_pendingRequests;
+
+signals:
+    void calculate();
+    void purge(const CacheUsageEntryList &entries);
+
+public slots:
+    void calculated(const CacheUsageEntryList &entries);
+    void purged(const CacheUsageEntry &entry, quint64 bytesFreed);
+};
+
+CacheUsageModelPrivate::CacheUsageModelPrivate(CacheUsageModel *model)
+    : QObject(model)
+    , q(model)
+    , m_thread(new QThread)
+    , m_worker(new CacheUsageWorker)
+    , m_pendingRequests(0)
+{
+    qRegisterMetaType<CacheUsageEntry>();
+    qRegisterMetaType<CacheUsageEntryList>();
+
+    m_worker->moveToThread(m_thread);
+
+    connect(this, &CacheUsageModelPrivate::calculate, m_worker, &CacheUsageWorker::calculate);
+    connect(this, &CacheUsageModelPrivate::purge, m_worker, &CacheUsageWorker::purge);
+    connect(m_worker, &CacheUsageWorker::calculated, this, &CacheUsageModelPrivate::calculated);
+    connect(m_worker, &CacheUsageWorker::purged, this, &CacheUsageModelPrivate::purged);
+
+    connect(m_thread, &QThread::finished, m_worker, &QObject::deleteLater);
+    connect(m_thread, &QThread::finished, m_thread, &QObject::deleteLater);
+
+    m_thread->start(QThread::LowPriority);
+}
+
+CacheUsageModelPrivate::~CacheUsageModelPrivate()
+{
+    // Make sure the worker quits as soon as possible
+    m_worker->scheduleQuit();
+
+    // Tell thread to shut down as early as possible
+    m_thread->quit();
+}
+
+void CacheUsageModelPrivate::setPendingRequests(int count)
+{
+    const bool wasWorking = m_pendingRequests > 0;
+    m_pendingRequests = count;
+    if (wasWorking != (m_pendingRequests > 0)) {
+        emit q->workingChanged();
+    }
+}
+
+qint64 CacheUsageModelPrivate::totalBytes() const
+{
+    qint64 total = 0;
+    for (const CacheUsageEntry &entry : m_entries) {
+        total += entry.bytes;
+    }
+    return total;
+}
+
+void CacheUsageModelPrivate::calculated(const CacheUsageEntryList &entries)
+{
+    const int count = m_entries.count();
+    const qint64 total = totalBytes();
+
+    q->beginResetModel();
+    m_entries = entries;
+    q->endResetModel();
+
+    if (count != m_entries.count()) {
+        emit q->countChanged();
+    }
+    if (total != totalBytes()) {
+        emit q->totalBytesChanged();
+    }
+
+    setPendingRequests(m_pendingRequests - 1);
+}
+
+void CacheUsageModelPrivate::purged(const CacheUsageEntry &entry, quint64 bytesFreed)
+{
+    const QString key = entry.key();
+    m_purging.remove(key);
+
+    for (int row = 0; row < m_entries.count(); ++row) {
+        if (m_entries.at(row).key() == key) {
+            m_entries[row].bytes = entry.bytes;
+            const QModelIndex index = q->index(row, 0);
+            emit q->dataChanged(index, index, QVector<int>() << CacheUsageModel::BytesRole << CacheUsageModel::PurgingRole);
+            break;
+        }
+    }
+
+    emit q->purged(entry.application, bytesFreed);
+    emit q->totalBytesChanged();
+
+    setPendingRequests(m_pendingRequests - 1);
+}
+
+CacheUsageModel::CacheUsageModel(QObject *parent)
+    : QAbstractListModel(parent)
+    , d_ptr(new CacheUsageModelPrivate(this))
+{
+    refresh();
+}
+
+CacheUsageModel::~CacheUsageModel()
+{
+}
+
+bool CacheUsageModel::working() const
+{
+    return d_ptr->m_pendingRequests > 0;
+}
+
+qint64 CacheUsageModel::totalBytes() const
+{
+    return d_ptr->totalBytes();
+}
+
+void CacheUsageModel::refresh()
+{
+    d_ptr->setPendingRequests(d_ptr->m_pendingRequests + 1);
+    emit d_ptr->calculate();
+}
+
+void CacheUsageModel::purge(int row)
+{
+    if (row < 0 || row >= d_ptr->m_entries.count())
+        return;
+
+    const CacheUsageEntry &entry = d_ptr->m_entries.at(row);
+    if (d_ptr->m_purging.contains(entry.key()))
+        return;
+
+    d_ptr->m_purging.insert(entry.key());
+    const QModelIndex idx = index(row, 0);
+    emit dataChanged(idx, idx, QVector<int>() << PurgingRole);
+
+    d_ptr->setPendingRequests(d_ptr->m_pendingRequests + 1);
+    emit d_ptr->purge(CacheUsageEntryList() << entry);
+}
+
+void CacheUsageModel::purgeAll()
+{
+    for (int row = 0; row < d_ptr->m_entries.count(); ++row) {
+        purge(row);
+    }
+}
+
+QHash<int, QByteArray> CacheUsageModel::roleNames() const
+{
+    static const QHash<int, QByteArray> roles = {
+        { ApplicationRole, "application" },
+        { CacheTypeRole, "cacheType" },
+        { PathsRole, "paths" },
+        { BytesRole, "bytes" },
+        { PurgingRole, "purging" },
+    };
+    return roles;
+}
+
+int CacheUsageModel::rowCount(const QModelIndex &parent) const
+{
+    return !parent.isValid() ? d_ptr->m_entries.count() : 0;
+}
+
+QVariant CacheUsageModel::data(const QModelIndex &index, int role) const
+{
+    if (index.row() < 0 || index.row() >= d_ptr->m_entries.count() || index.column() != 0)
+        return QVariant();
+
+    const CacheUsageEntry &entry = d_ptr->m_entries.at(index.row());
+    switch (role) {
+    case ApplicationRole:
+        return entry.application;
+    case CacheTypeRole:
+        return entry.type;
+    case PathsRole:
+        return entry.paths;
+    case BytesRole:
+        return qint64(entry.bytes);
+    case PurgingRole:
+        return d_ptr->m_purging.contains(entry.key());
+    default:
+        return QVariant();
+    }
+}
+
+#include "cacheusagemodel.moc"
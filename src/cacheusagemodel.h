@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2026 Nemo Mobile Project
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#ifndef CACHEUSAGEMODEL_H
+#define CACHEUSAGEMODEL_H
+
+#include <QAbstractListModel>
+
+#include "systemsettingsglobal.h"
+
+class CacheUsageModelPrivate;
+
+class SYSTEMSETTINGS_EXPORT CacheUsageModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
+    Q_PROPERTY(bool working READ working NOTIFY workingChanged)
+    Q_PROPERTY(qint64 totalBytes READ totalBytes NOTIFY totalBytesChanged)
+
+public:
+    enum Roles {
+        ApplicationRole = Qt::UserRole + 1,
+        CacheTypeRole,
+        PathsRole,
+        BytesRole,
+        PurgingRole,
+    };
+    Q_ENUM(Roles)
+
+    enum CacheType {
+        ApplicationCache,
+        AndroidApplicationCache,
+        Trash,
+    };
+    Q_ENUM(CacheType)
+
+    explicit CacheUsageModel(QObject *parent = 0);
+    ~CacheUsageModel();
+
+    bool working() const;
+    qint64 totalBytes() const;
+
+    Q_INVOKABLE void refresh();
+    Q_INVOKABLE void purge(int row);
+    Q_INVOKABLE void purgeAll();
+
+    QHash<int, QByteArray> roleNames() const;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role) const;
+
+signals:
+    void countChanged();
+    void workingChanged();
+    void totalBytesChanged();
+    void purged(const QString &application, qint64 bytesFreed);
+
+private:
+    CacheUsageModelPrivate *d_ptr;
+
+    friend class CacheUsageModelPrivate;
+};
+
+#endif
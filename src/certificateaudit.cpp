@@ -0,0 +1,368 @@
+/*
+ * Copyright (C) 2026 Nemo Mobile Project
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include "certificateaudit.h"
+#include "certificatemodel_p.h"
+
+#include <QCoreApplication>
+#include <QEvent>
+#include <QHash>
+#include <QPointer>
+#include <QRunnable>
+#include <QSet>
+#include <QThreadPool>
+#include <QVector>
+#include <QDebug>
+#include <algorithm>
+
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+#include <openssl/x509_vfy.h>
+
+namespace {
+
+X509 *decode(const QByteArray &der)
+{
+    const unsigned char *in = reinterpret_cast<const unsigned char *>(der.constData());
+    return d2i_X509(nullptr, &in, der.length());
+}
+
+QString fingerprint(X509 *x509)
+{
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int length = 0;
+    if (!X509_digest(x509, EVP_sha256(), digest, &length)) {
+        return QString();
+    }
+    return QString::fromLatin1(QByteArray(reinterpret_cast<const char *>(digest), length).toHex());
+}
+
+QString subject(X509 *x509)
+{
+    char buffer[256];
+    X509_NAME_oneline(X509_get_subject_name(x509), buffer, sizeof(buffer));
+    return QString::fromUtf8(buffer);
+}
+
+// Trust anchors of the system bundles, each certificate added once.
+class TrustStore
+{
+public:
+    TrustStore()
+        : m_store(X509_STORE_new())
+    {
+        QList<Certificate> anchors;
+        QSet<QByteArray> fingerprints;
+        const QStringList paths = systemBundlePaths();
+        for (const QString &path : paths) {
+            const QList<Certificate> certificates = CertificateModel::getCertificates(path);
+            for (const Certificate &certificate : certificates) {
+                if (!fingerprints.contains(certificate.fingerprint())) {
+                    fingerprints.insert(certificate.fingerprint());
+                    anchors.append(certificate);
+                }
+            }
+        }
+
+        QVector<X509 *> decoded(anchors.count(), nullptr);
+        X509 **out = decoded.data();
+        parallelFor(anchors.count(), [&anchors, out](int i) {
+            out[i] = decode(anchors.at(i).toDer());
+        });
+
+        for (X509 *x509 : decoded) {
+            if (x509) {
+                X509_STORE_add_cert(m_store, x509);
+                X509_free(x509);
+            }
+        }
+        ERR_clear_error();
+    }
+
+    ~TrustStore()
+    {
+        X509_STORE_free(m_store);
+    }
+
+    QVariantMap verify(X509 *certificate, STACK_OF(X509) *untrusted) const
+    {
+        QVariantMap result;
+        result.insert(QStringLiteral("subject"), subject(certificate));
+        result.insert(QStringLiteral("fingerprint"), fingerprint(certificate));
+
+        X509_STORE_CTX *context = X509_STORE_CTX_new();
+        if (!context || X509_STORE_CTX_init(context, m_store, certificate, untrusted) != 1) {
+            result.insert(QStringLiteral("trusted"), false);
+            result.insert(QStringLiteral("errorString"), QStringLiteral("Unable to prepare the verification"));
+        } else {
+            const bool trusted = X509_verify_cert(context) == 1;
+            const int error = X509_STORE_CTX_get_error(context);
+            result.insert(QStringLiteral("trusted"), trusted);
+            result.insert(QStringLiteral("error"), error);
+            result.insert(QStringLiteral("errorString"), QString::fromUtf8(X509_verify_cert_error_string(error)));
+            result.insert(QStringLiteral("errorDepth"), X509_STORE_CTX_get_error_depth(context));
+        }
+        X509_STORE_CTX_free(context);
+
+        return result;
+    }
+
+    QVariantMap verify(const QByteArray &pem) const
+    {
+        X509 *certificate = nullptr;
+        STACK_OF(X509) *untrusted = sk_X509_new_null();
+
+        BIO *input = BIO_new_mem_buf(pem.constData(), pem.length());
+        if (input) {
+            while (X509 *x509 = PEM_read_bio_X509_AUX(input, NULL, NULL, NULL)) {
+                if (!certificate) {
+                    certificate = x509;
+                } else {
+                    sk_X509_push(untrusted, x509);
+                }
+            }
+            BIO_free(input);
+        }
+        ERR_clear_error();
+
+        QVariantMap result;
+        if (certificate) {
+            result = verify(certificate, untrusted);
+            X509_free(certificate);
+        } else {
+            result.insert(QStringLiteral("trusted"), false);
+            result.insert(QStringLiteral("errorString"), QStringLiteral("No certificate found"));
+        }
+        sk_X509_pop_free(untrusted, X509_free);
+
+        return result;
+    }
+
+private:
+    X509_STORE *m_store;
+};
+
+QVariantList toList(const QVector<QVariantMap> &results)
+{
+    QVariantList rv;
+    rv.reserve(results.count());
+    for (const QVariantMap &result : results) {
+        rv.append(result);
+    }
+    return rv;
+}
+
+const QEvent::Type AuditFinishedEvent = QEvent::Type(QEvent::User + 1);
+
+class AuditEvent : public QEvent
+{
+public:
+    AuditEvent(bool verification, const QVariantList &results)
+        : QEvent(AuditFinishedEvent), m_verification(verification), m_results(results)
+    {
+    }
+
+    bool m_verification;
+    QVariantList m_results;
+};
+
+class AuditTask : public QRunnable
+{
+public:
+    AuditTask(CertificateAudit *owner, const QList<QByteArray> &pemBlobs)
+        : m_owner(owner), m_verification(true), m_pemBlobs(pemBlobs), m_days(0)
+    {
+    }
+
+    AuditTask(CertificateAudit *owner, int days)
+        : m_owner(owner), m_verification(false), m_days(days)
+    {
+    }
+
+    void run() override
+    {
+        const QVariantList results = m_verification
+                ? CertificateAudit::verifyCertificates(m_pemBlobs)
+                : CertificateAudit::expiringCertificates(m_days);
+
+        if (m_owner) {
+            QCoreApplication::postEvent(m_owner, new AuditEvent(m_verification, results));
+        }
+    }
+
+private:
+    QPointer<CertificateAudit> m_owner;
+    bool m_verification;
+    QList<QByteArray> m_pemBlobs;
+    int m_days;
+};
+
+}
+
+CertificateAudit::CertificateAudit(QObject *parent)
+    : QObject(parent)
+    , m_pending(0)
+{
+}
+
+CertificateAudit::~CertificateAudit()
+{
+}
+
+bool CertificateAudit::running() const
+{
+    return m_pending > 0;
+}
+
+void CertificateAudit::verify(const QStringList &pemBlobs)
+{
+    QList<QByteArray> blobs;
+    for (const QString &pem : pemBlobs) {
+        blobs.append(pem.toUtf8());
+    }
+
+    if (m_pending++ == 0) {
+        emit runningChanged();
+    }
+    QThreadPool::globalInstance()->start(new AuditTask(this, blobs));
+}
+
+void CertificateAudit::scanExpiry(int days)
+{
+    if (m_pending++ == 0) {
+        emit runningChanged();
+    }
+    QThreadPool::globalInstance()->start(new AuditTask(this, days));
+}
+
+QVariantList CertificateAudit::verifyCertificates(const QList<QByteArray> &pemBlobs)
+{
+    const TrustStore store;
+
+    QVector<QVariantMap> results(pemBlobs.count());
+    QVariantMap *out = results.data();
+    parallelFor(pemBlobs.count(), [&store, &pemBlobs, out](int i) {
+        out[i] = store.verify(pemBlobs.at(i));
+    });
+
+    return toList(results);
+}
+
+QVariantList CertificateAudit::verifyCertificates(const QList<Certificate> &certificates)
+{
+    const TrustStore store;
+
+    QVector<QVariantMap> results(certificates.count());
+    QVariantMap *out = results.data();
+    parallelFor(certificates.count(), [&store, &certificates, out](int i) {
+        if (X509 *x509 = decode(certificates.at(i).toDer())) {
+            out[i] = store.verify(x509, nullptr);
+            X509_free(x509);
+        } else {
+            out[i].insert(QStringLiteral("trusted"), false);
+            out[i].insert(QStringLiteral("errorString"), QStringLiteral("Unable to decode certificate"));
+        }
+    });
+
+    return toList(results);
+}
+
+QVariantList CertificateAudit::expiringCertificates(int days)
+{
+    // Certificates present in several bundles are reported once, listing the bundles.
+    QList<Certificate> certificates;
+    QVector<QStringList> bundles;
+    QHash<QByteArray, int> positions;
+
+    const QStringList paths = systemBundlePaths();
+    for (const QString &path : paths) {
+        const QList<Certificate> bundle = CertificateModel::getCertificates(path);
+        for (const Certificate &certificate : bundle) {
+            auto it = positions.constFind(certificate.fingerprint());
+            if (it != positions.constEnd()) {
+                bundles[*it].append(path);
+            } else {
+                positions.insert(certificate.fingerprint(), certificates.count());
+                certificates.append(certificate);
+                bundles.append(QStringList() << path);
+            }
+        }
+    }
+
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    const QDateTime limit = now.addDays(days);
+
+    // Only reads fields decoded with the certificate, not worth spreading over threads.
+    QVector<QVariantMap> expiring;
+    for (int i = 0; i < certificates.count(); ++i) {
+        const Certificate &certificate = certificates.at(i);
+        const QDateTime notValidAfter = certificate.notValidAfter();
+        if (!notValidAfter.isValid() || notValidAfter > limit) {
+            continue;
+        }
+
+        QVariantMap result;
+        result.insert(QStringLiteral("primaryName"), certificate.primaryName());
+        result.insert(QStringLiteral("secondaryName"), certificate.secondaryName());
+        result.insert(QStringLiteral("fingerprint"), QString::fromLatin1(certificate.fingerprint().toHex()));
+        result.insert(QStringLiteral("notValidAfter"), notValidAfter);
+        result.insert(QStringLiteral("expired"), notValidAfter < now);
+        result.insert(QStringLiteral("daysRemaining"), now.daysTo(notValidAfter));
+        result.insert(QStringLiteral("bundles"), bundles.at(i));
+        expiring.append(result);
+    }
+    std::stable_sort(expiring.begin(), expiring.end(), [](const QVariantMap &lhs, const QVariantMap &rhs) {
+        return lhs.value(QStringLiteral("notValidAfter")).toDateTime() < rhs.value(QStringLiteral("notValidAfter")).toDateTime();
+    });
+
+    return toList(expiring);
+}
+
+bool CertificateAudit::event(QEvent *event)
+{
+    if (event->type() == AuditFinishedEvent) {
+        AuditEvent *audit = static_cast<AuditEvent *>(event);
+        if (audit->m_verification) {
+            emit verified(audit->m_results);
+        } else {
+            emit expiryScanned(audit->m_results);
+        }
+
+        if (--m_pending == 0) {
+            emit runningChanged();
+        }
+        return true;
+    }
+
+    return QObject::event(event);
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2026 Nemo Mobile Project
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#ifndef CERTIFICATEAUDIT_H
+#define CERTIFICATEAUDIT_H
+
+#include <QObject>
+#include <QStringList>
+#include <QVariantList>
+
+#include "certificatemodel.h"
+#include "systemsettingsglobal.h"
+
+// Audits certificates against the system trust store, made of the TLS,
+// email and object signing bundles. The per-certificate work is spread
+// over a thread pool.
+class SYSTEMSETTINGS_EXPORT CertificateAudit : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool running READ running NOTIFY runningChanged)
+
+public:
+    explicit CertificateAudit(QObject *parent = 0);
+    virtual ~CertificateAudit();
+
+    bool running() const;
+
+    // Each PEM blob holds the certificate to verify, optionally followed by
+    // the intermediate certificates of its chain. The result is emitted
+    // with verified().
+    Q_INVOKABLE void verify(const QStringList &pemBlobs);
+
+    // Looks for the certificates of the system bundles that expire within
+    // the given number of days or have already expired. The result is
+    // emitted with expiryScanned().
+    Q_INVOKABLE void scanExpiry(int days = 30);
+
+    // Blocking variants of the above, returning a map per certificate.
+    static QVariantList verifyCertificates(const QList<QByteArray> &pemBlobs);
+    static QVariantList verifyCertificates(const QList<Certificate> &certificates);
+    static QVariantList expiringCertificates(int days);
+
+Q_SIGNALS:
+    void runningChanged();
+    void verified(const QVariantList &results);
+    void expiryScanned(const QVariantList &certificates);
+
+protected:
+    bool event(QEvent *event);
+
+private:
+    int m_pending;
+};
+
+#endif
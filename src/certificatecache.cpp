@@ -0,0 +1,251 @@
+/*
+ * Copyright (C) 2026 Nemo Mobile Project
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include "certificatecache_p.h"
+#include "certificatemodel_p.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QVector>
+#include <QDebug>
+
+#include <limits>
+#include <string.h>
+#include <sys/stat.h>
+
+namespace {
+
+const quint32 CacheMagic = 0x4e435254; // "NCRT"
+const quint32 CacheVersion = 2;
+const qint64 InvalidTime = std::numeric_limits<qint64>::min();
+
+QString CertificatePrivate::* const stringFields[] = {
+    &CertificatePrivate::commonName,
+    &CertificatePrivate::countryName,
+    &CertificatePrivate::organizationName,
+    &CertificatePrivate::organizationalUnitName,
+    &CertificatePrivate::primaryName,
+    &CertificatePrivate::secondaryName,
+    &CertificatePrivate::issuerDisplayName
+};
+const int StringFieldCount = sizeof(stringFields) / sizeof(stringFields[0]);
+
+struct Header
+{
+    quint32 magic;
+    quint32 version;
+    quint64 device;
+    quint64 inode;
+    qint64 size;
+    qint64 modified;
+    quint32 count;
+    quint32 stringsOffset;  // Bytes from the start of the file
+};
+
+// Offset and length in UTF-16 code units from the start of the string table.
+struct StringRef
+{
+    quint32 offset;
+    quint32 length;
+};
+
+struct Record
+{
+    StringRef strings[StringFieldCount];
+    qint64 notValidBefore;  // Milliseconds since the epoch
+    qint64 notValidAfter;
+    qint32 notValidBeforeOffset;    // Seconds from UTC
+    qint32 notValidAfterOffset;
+    qint64 pemOffset;
+    qint64 pemLength;
+    uchar fingerprint[32];  // SHA-256
+};
+
+QString cachePath(const QString &bundlePath)
+{
+    const QByteArray hash = QCryptographicHash::hash(bundlePath.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+            + QStringLiteral("/nemo-systemsettings/certificates/")
+            + QString::fromLatin1(hash) + QStringLiteral(".cache");
+}
+
+qint64 timeToRecord(const QDateTime &time)
+{
+    return time.isValid() ? time.toMSecsSinceEpoch() : InvalidTime;
+}
+
+QDateTime timeFromRecord(qint64 time, qint32 offset)
+{
+    return time != InvalidTime ? QDateTime::fromMSecsSinceEpoch(time, Qt::OffsetFromUTC, offset) : QDateTime();
+}
+
+}
+
+namespace CertificateCache {
+
+bool stamp(const QString &bundlePath, Stamp *stamp)
+{
+    struct stat st;
+    if (::stat(QFile::encodeName(bundlePath).constData(), &st) != 0) {
+        return false;
+    }
+
+    stamp->device = st.st_dev;
+    stamp->inode = st.st_ino;
+    stamp->size = st.st_size;
+    stamp->modified = qint64(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+    return true;
+}
+
+bool load(const QString &bundlePath, const Stamp &bundleStamp, QList<Certificate> *certificates)
+{
+    QFile file(cachePath(bundlePath));
+    if (!file.open(QIODevice::ReadOnly) || file.size() < qint64(sizeof(Header))) {
+        return false;
+    }
+
+    const qint64 size = file.size();
+    const uchar *data = file.map(0, size);
+    if (!data) {
+        return false;
+    }
+
+    const Header *header = reinterpret_cast<const Header *>(data);
+    Stamp cacheStamp;
+    cacheStamp.device = header->device;
+    cacheStamp.inode = header->inode;
+    cacheStamp.size = header->size;
+    cacheStamp.modified = header->modified;
+
+    const qint64 recordsEnd = qint64(sizeof(Header)) + qint64(header->count) * qint64(sizeof(Record));
+    if (header->magic != CacheMagic || header->version != CacheVersion || !(cacheStamp == bundleStamp)
+            || recordsEnd > header->stringsOffset || header->stringsOffset > size
+            || header->stringsOffset % sizeof(QChar) != 0) {
+        file.unmap(const_cast<uchar *>(data));
+        return false;
+    }
+
+    const Record *records = reinterpret_cast<const Record *>(data + sizeof(Header));
+    const QChar *strings = reinterpret_cast<const QChar *>(data + header->stringsOffset);
+    const qint64 stringsLength = (size - header->stringsOffset) / qint64(sizeof(QChar));
+
+    QList<Certificate> rv;
+    rv.reserve(header->count);
+    for (quint32 i = 0; i < header->count; ++i) {
+        const Record &record = records[i];
+
+        QExplicitlySharedDataPointer<CertificatePrivate> d(new CertificatePrivate);
+        for (int field = 0; field < StringFieldCount; ++field) {
+            const StringRef &ref = record.strings[field];
+            if (qint64(ref.offset) + ref.length > stringsLength) {
+                file.unmap(const_cast<uchar *>(data));
+                return false;
+            }
+            (*d).*stringFields[field] = QString(strings + ref.offset, ref.length);
+        }
+        d->notValidBefore = timeFromRecord(record.notValidBefore, record.notValidBeforeOffset);
+        d->notValidAfter = timeFromRecord(record.notValidAfter, record.notValidAfterOffset);
+        d->pemPath = bundlePath;
+        d->pemOffset = record.pemOffset;
+        d->pemLength = record.pemLength;
+        d->fingerprint = QByteArray(reinterpret_cast<const char *>(record.fingerprint), sizeof(record.fingerprint));
+        d->updateKeys();
+
+        rv.append(CertificatePrivate::create(d));
+    }
+
+    file.unmap(const_cast<uchar *>(data));
+
+    *certificates = rv;
+    return true;
+}
+
+void store(const QString &bundlePath, const Stamp &stamp, const QList<Entry> &entries)
+{
+    QVector<Record> records;
+    records.reserve(entries.count());
+    QString strings;
+
+    for (const Entry &entry : entries) {
+        const CertificatePrivate *d = entry.certificate.data();
+
+        Record record;
+        for (int field = 0; field < StringFieldCount; ++field) {
+            const QString &value = (*d).*stringFields[field];
+            record.strings[field].offset = strings.length();
+            record.strings[field].length = value.length();
+            strings.append(value);
+        }
+        record.notValidBefore = timeToRecord(d->notValidBefore);
+        record.notValidAfter = timeToRecord(d->notValidAfter);
+        record.notValidBeforeOffset = d->notValidBefore.offsetFromUtc();
+        record.notValidAfterOffset = d->notValidAfter.offsetFromUtc();
+        record.pemOffset = entry.pemOffset;
+        record.pemLength = entry.pemLength;
+        memset(record.fingerprint, 0, sizeof(record.fingerprint));
+        memcpy(record.fingerprint, d->fingerprint.constData(), qMin<int>(d->fingerprint.length(), sizeof(record.fingerprint)));
+        records.append(record);
+    }
+
+    Header header;
+    memset(&header, 0, sizeof(header));
+    header.magic = CacheMagic;
+    header.version = CacheVersion;
+    header.device = stamp.device;
+    header.inode = stamp.inode;
+    header.size = stamp.size;
+    header.modified = stamp.modified;
+    header.count = records.count();
+    header.stringsOffset = sizeof(Header) + records.count() * sizeof(Record);
+
+    const QString path = cachePath(bundlePath);
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Unable to write certificate cache:" << path << file.errorString();
+        return;
+    }
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(records.constData()), records.count() * sizeof(Record));
+    file.write(reinterpret_cast<const char *>(strings.constData()), strings.length() * sizeof(QChar));
+
+    if (!file.commit()) {
+        qWarning() << "Unable to write certificate cache:" << path << file.errorString();
+    }
+}
+
+}
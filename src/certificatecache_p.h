@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2026 Nemo Mobile Project
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#ifndef CERTIFICATECACHE_P_H
+#define CERTIFICATECACHE_P_H
+
+#include <QExplicitlySharedDataPointer>
+#include <QList>
+#include <QString>
+
+class Certificate;
+class CertificatePrivate;
+
+// Binary cache of the list view fields of parsed certificate bundles. The
+// records point back to the PEM blocks in the bundle, which is parsed
+// again only when the file stamp of the bundle no longer matches.
+namespace CertificateCache {
+
+struct Stamp
+{
+    quint64 device = 0;
+    quint64 inode = 0;
+    qint64 size = -1;
+    qint64 modified = -1;   // Nanoseconds since the epoch
+
+    bool operator ==(const Stamp &other) const
+    {
+        return device == other.device && inode == other.inode
+                && size == other.size && modified == other.modified;
+    }
+};
+
+struct Entry
+{
+    QExplicitlySharedDataPointer<CertificatePrivate> certificate;
+    // Location of the PEM block in the bundle being stored.
+    qint64 pemOffset;
+    qint64 pemLength;
+};
+
+bool stamp(const QString &bundlePath, Stamp *stamp);
+
+// Returns false when there is no cache for the bundle or it does not match the stamp.
+bool load(const QString &bundlePath, const Stamp &stamp, QList<Certificate> *certificates);
+void store(const QString &bundlePath, const Stamp &stamp, const QList<Entry> &entries);
+
+}
+
+#endif
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2026 Nemo Mobile Project
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include "certificatefiltermodel.h"
+#include "certificatemodel_p.h"
+#include "certificatestore_p.h"
+
+CertificateFilterModel::CertificateFilterModel(QObject *parent)
+    : QSortFilterProxyModel(parent)
+    , m_model(nullptr)
+    , m_searched(0)
+    , m_count(0)
+{
+    const auto updateCount = [this]() {
+        if (m_count != rowCount()) {
+            m_count = rowCount();
+            emit countChanged();
+        }
+    };
+    connect(this, &QAbstractItemModel::rowsInserted, this, updateCount);
+    connect(this, &QAbstractItemModel::rowsRemoved, this, updateCount);
+    connect(this, &QAbstractItemModel::modelReset, this, updateCount);
+    connect(this, &QAbstractItemModel::layoutChanged, this, updateCount);
+}
+
+CertificateFilterModel::~CertificateFilterModel()
+{
+}
+
+CertificateModel *CertificateFilterModel::model() const
+{
+    return m_model;
+}
+
+void CertificateFilterModel::setModel(CertificateModel *model)
+{
+    if (m_model != model) {
+        m_model = model;
+        setSourceModel(model);
+        emit modelChanged();
+    }
+}
+
+QString CertificateFilterModel::filter() const
+{
+    return m_filter;
+}
+
+void CertificateFilterModel::setFilter(const QString &filter)
+{
+    if (m_filter != filter) {
+        m_filter = filter;
+        m_words = foldedWords(filter);
+
+        // The prefix index of the store answers for all the certificates at once,
+        // the rows are then only looked up from the result.
+        m_matches.clear();
+        m_searched = 0;
+        if (!m_words.isEmpty()) {
+            m_matches = CertificateStore::instance()->search(m_words, &m_searched);
+        }
+
+        invalidateFilter();
+        emit filterChanged();
+    }
+}
+
+int CertificateFilterModel::count() const
+{
+    return m_count;
+}
+
+bool CertificateFilterModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
+{
+    if (m_words.isEmpty() || !m_model || sourceParent.isValid()) {
+        return true;
+    }
+
+    bool valid = false;
+    const int index = m_model->data(m_model->index(sourceRow), CertificateStoreIndexRole).toInt(&valid);
+    if (!valid) {
+        return true;
+    } else if (index < m_searched) {
+        return m_matches.contains(index);
+    }
+
+    // Added to the store after the search.
+    return CertificateStore::matches(CertificateStore::instance()->certificate(index), m_words);
+}
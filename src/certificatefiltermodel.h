@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2026 Nemo Mobile Project
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#ifndef CERTIFICATEFILTERMODEL_H
+#define CERTIFICATEFILTERMODEL_H
+
+#include <QPointer>
+#include <QSet>
+#include <QSortFilterProxyModel>
+#include <QStringList>
+
+#include "certificatemodel.h"
+#include "systemsettingsglobal.h"
+
+// Type-to-filter over a CertificateModel. A certificate is shown when each
+// word of the filter starts a word of its primary name, secondary name or
+// organization name, ignoring case and accents.
+class SYSTEMSETTINGS_EXPORT CertificateFilterModel : public QSortFilterProxyModel
+{
+    Q_OBJECT
+    Q_PROPERTY(CertificateModel *model READ model WRITE setModel NOTIFY modelChanged)
+    Q_PROPERTY(QString filter READ filter WRITE setFilter NOTIFY filterChanged)
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+public:
+    explicit CertificateFilterModel(QObject *parent = 0);
+    virtual ~CertificateFilterModel();
+
+    CertificateModel *model() const;
+    void setModel(CertificateModel *model);
+
+    QString filter() const;
+    void setFilter(const QString &filter);
+
+    int count() const;
+
+Q_SIGNALS:
+    void modelChanged();
+    void filterChanged();
+    void countChanged();
+
+protected:
+    virtual bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const;
+
+private:
+    QPointer<CertificateModel> m_model;
+    QString m_filter;
+    QStringList m_words;
+    QSet<int> m_matches;
+    int m_searched;
+    int m_count;
+};
+
+#endif
@@ -30,13 +30,31 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
  */
 
-#include "certificatemodel.h"
-
+#include "certificatemodel_p.h"
+#include "certificatecache_p.h"
+#include "certificatestore_p.h"
+
+#include <QAtomicInt>
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QEvent>
 #include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QPointer>
 #include <QRegularExpression>
+#include <QRunnable>
+#include <QSet>
+#include <QThreadPool>
+#include <QTimer>
 #include <QDebug>
+#include <algorithm>
 #include <functional>
 
+#include <dirent.h>
+#include <sys/stat.h>
+#include <time.h>
+
 #include <openssl/opensslv.h>
 #include <openssl/bio.h>
 #include <openssl/conf.h>
@@ -49,6 +67,7 @@
 namespace {
 
 struct X509List;
+struct PEMBundle;
 
 }
 
@@ -66,6 +85,10 @@ struct X509Certificate
     {
         return nameElement(X509_get_subject_name(x509), nid);
     }
+    void subjectElements(const int *nids, QString *values, int count) const
+    {
+        nameElements(X509_get_subject_name(x509), nids, values, count);
+    }
 
     QList<QPair<QString, QString>> issuerList(bool shortForm = false) const
     {
@@ -79,6 +102,10 @@ struct X509Certificate
     {
         return nameElement(X509_get_issuer_name(x509), nid);
     }
+    void issuerElements(const int *nids, QString *values, int count) const
+    {
+        nameElements(X509_get_issuer_name(x509), nids, values, count);
+    }
 
     QString version() const
     {
@@ -157,11 +184,18 @@ struct X509Certificate
 
         rv.append(qMakePair(QStringLiteral("Algorithm"), objectToString(sig_alg->algorithm, shortForm)));
 
-        BIO *b = BIO_new(BIO_s_mem());
-        X509_signature_dump(b, sig, 0);
-        QString d(bioToString(b).replace(QChar('\n'), QString()));
-        rv.append(qMakePair(QStringLiteral("Data"), d.trimmed()));
-        BIO_free(b);
+        // Same colon separated hex as X509_signature_dump(), without the line breaks.
+        const int length = ASN1_STRING_length(sig);
+        const unsigned char *data = ASN1_STRING_get0_data(sig);
+        QString d;
+        d.reserve(length * 3);
+        for (int i = 0; i < length; ++i) {
+            if (i > 0) {
+                d.append(QChar(':'));
+            }
+            d.append(QString::number(data[i], 16).rightJustified(2, QChar('0')));
+        }
+        rv.append(qMakePair(QStringLiteral("Data"), d));
 
         return rv;
     }
@@ -237,6 +271,25 @@ private:
         return QString();
     }
 
+    // Fills in the first value of each of the nids in a single pass over the name.
+    static void nameElements(X509_NAME *name, const int *nids, QString *values, int count)
+    {
+        quint32 found = 0;
+        const quint32 all = (1u << count) - 1;
+
+        for (int i = 0, n = X509_NAME_entry_count(name); i < n && found != all; ++i) {
+            X509_NAME_ENTRY *entry = X509_NAME_get_entry(name, i);
+            const int nid = OBJ_obj2nid(X509_NAME_ENTRY_get_object(entry));
+            for (int j = 0; j < count; ++j) {
+                if (nids[j] == nid && !(found & (1u << j))) {
+                    values[j] = stringToString(X509_NAME_ENTRY_get_data(entry));
+                    found |= 1u << j;
+                    break;
+                }
+            }
+        }
+    }
+
     static QString toString(const QList<QPair<QString, QString>> &list, const QString &separator = QString(", "))
     {
         QString rv;
@@ -255,8 +308,18 @@ private:
 
     static QDateTime toDateTime(ASN1_TIME *time)
     {
+#if OPENSSL_VERSION_NUMBER >= 0x10101000L
+        // Normalized to UTC by OpenSSL, certificates carry no fractions of seconds.
+        struct tm tm;
+        if (ASN1_TIME_to_tm(time, &tm) != 1) {
+            return QDateTime();
+        }
+        return QDateTime(QDate(tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday),
+                         QTime(tm.tm_hour, tm.tm_min, tm.tm_sec), Qt::OffsetFromUTC, 0);
+#else
         const QString ts(timeToString(time));
         return (time->type == V_ASN1_GENERALIZEDTIME ? fromGENERALIZEDTIME(ts) : fromUTCTIME(ts));
+#endif
     }
 
     static QDateTime fromUTCTIME(const QString &ts)
@@ -266,7 +329,7 @@ private:
         int offset = 0;
 
         // "YYMMDDhhmm[ss](Z|(+|-)hhmm)"
-        const QRegularExpression re("([0-9]{2})([0-9]{2})([0-9]{2})([0-9]{2})([0-9]{2})([0-9]{2})?(Z)?(([+-])([0-9]{2})([0-9]{2}))?");
+        static const QRegularExpression re("([0-9]{2})([0-9]{2})([0-9]{2})([0-9]{2})([0-9]{2})([0-9]{2})?(Z)?(([+-])([0-9]{2})([0-9]{2}))?");
         QRegularExpressionMatch match = re.match(ts);
         if (match.hasMatch()) {
             int y = match.captured(1).toInt();
@@ -292,7 +355,7 @@ private:
         int offset = 0;
 
         // "YYYYMMDDhh[mm[ss[.fff]]](Z|(+|-)hhmm)" <- nested optionals can be treated as appearing sequentially
-        const QRegularExpression re("([0-9]{4})([0-9]{2})([0-9]{2})([0-9]{2})([0-9]{2})?([0-9]{2})?(\\.[0-9]{1,3})?(Z)?(([+-])([0-9]{2})([0-9]{2}))?");
+        static const QRegularExpression re("([0-9]{4})([0-9]{2})([0-9]{2})([0-9]{2})([0-9]{2})?([0-9]{2})?(\\.[0-9]{1,3})?(Z)?(([+-])([0-9]{2})([0-9]{2}))?");
         QRegularExpressionMatch match = re.match(ts);
         if (match.hasMatch()) {
             d = QDate(match.captured(1).toInt(), match.captured(2).toInt(), match.captured(3).toInt());
@@ -335,6 +398,8 @@ private:
     }
 
     friend struct ::X509List;
+    friend struct ::PEMBundle;
+    friend class ::CertificatePrivate;
 
     X509Certificate(X509 *x) : x509(x) {}
 
@@ -497,6 +562,110 @@ private:
     X509List certs;
 };
 
+// Reads a PEM bundle file block by block, keeping the location of each
+// certificate in the file. A file holding a single DER certificate, as .crt
+// and .cer files often do, is read as one block spanning the whole file.
+struct PEMBundle
+{
+    explicit PEMBundle(const QString &path)
+        : path(path), valid(false), binary(false)
+    {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            qWarning() << "Unable to open PEM bundle:" << path;
+        } else {
+            data = file.readAll();
+            valid = true;
+            // DER certificates are an ASN.1 SEQUENCE.
+            binary = data.startsWith('\x30') && !data.contains("-----BEGIN ");
+        }
+    }
+
+    bool isValid() const
+    {
+        return valid;
+    }
+
+    // Calls fn with the offset and the length of each PEM block in the file.
+    void for_each(std::function<void (int, int)> fn) const
+    {
+        static const QByteArray beginMarker("-----BEGIN ");
+        static const QByteArray endMarker("-----END ");
+        static const QByteArray dashes("-----");
+
+        if (binary) {
+            fn(0, data.length());
+            return;
+        }
+
+        int begin = data.indexOf(beginMarker);
+        while (begin != -1) {
+            int end = data.indexOf(endMarker, begin);
+            if (end != -1) {
+                end = data.indexOf(dashes, end + endMarker.length());
+            }
+            if (end == -1) {
+                break;
+            }
+            end += dashes.length();
+
+            fn(begin, end - begin);
+
+            begin = data.indexOf(beginMarker, end);
+        }
+    }
+
+    // Returns the DER of a plain certificate block without decoding the certificate,
+    // or an empty array for the other kinds of blocks.
+    QByteArray der(int offset, int length) const
+    {
+        static const QByteArray header("-----BEGIN CERTIFICATE-----");
+        static const QByteArray footer("-----END CERTIFICATE-----");
+
+        const QByteArray block = QByteArray::fromRawData(data.constData() + offset, length);
+        if (binary) {
+            return QByteArray(block.constData(), block.length());
+        } else if (!block.startsWith(header) || !block.endsWith(footer)) {
+            return QByteArray();
+        }
+
+        // Line breaks are skipped by the base64 decoding.
+        return QByteArray::fromBase64(block.mid(header.length(), length - header.length() - footer.length()));
+    }
+
+    // Blocks other than certificates do not decode and yield a null pointer.
+    QExplicitlySharedDataPointer<CertificatePrivate> parse(int offset, int length) const
+    {
+        QExplicitlySharedDataPointer<CertificatePrivate> d;
+
+        BIO *input = BIO_new_mem_buf(data.constData() + offset, length);
+        if (input) {
+            X509 *x509 = binary
+                    ? d2i_X509_bio(input, NULL)
+                    : PEM_read_bio_X509_AUX(input, NULL, NULL, NULL);
+            if (x509) {
+                d = new CertificatePrivate;
+                d->setCertificate(X509Certificate(x509));
+                d->pemPath = path;
+                d->pemOffset = offset;
+                d->pemLength = length;
+                X509_free(x509);
+            } else {
+                ERR_clear_error();
+            }
+            BIO_free(input);
+        }
+
+        return d;
+    }
+
+private:
+    QString path;
+    QByteArray data;
+    bool valid;
+    bool binary;
+};
+
 class LibCrypto
 {
     struct Initializer
@@ -540,12 +709,14 @@ LibCrypto::Initializer LibCrypto::init;
 
 const QList<QPair<QString, CertificateModel::BundleType> > &bundlePaths()
 {
-    static QList<QPair<QString, CertificateModel::BundleType> > paths;
-    if (paths.isEmpty()) {
+    // Initialized once, also when first asked from a worker thread.
+    static const QList<QPair<QString, CertificateModel::BundleType> > paths = [] {
+        QList<QPair<QString, CertificateModel::BundleType> > paths;
         paths.append(qMakePair(QString("/etc/pki/ca-trust/extracted/pem/tls-ca-bundle.pem"), CertificateModel::TLSBundle));
         paths.append(qMakePair(QString("/etc/pki/ca-trust/extracted/pem/email-ca-bundle.pem"), CertificateModel::EmailBundle));
         paths.append(qMakePair(QString("/etc/pki/ca-trust/extracted/pem/objsign-ca-bundle.pem"), CertificateModel::ObjectSigningBundle));
-    }
+        return paths;
+    }();
     return paths;
 }
 
@@ -577,25 +748,458 @@ QString bundlePath(CertificateModel::BundleType type)
     return QStringLiteral("");
 }
 
+// Returns the bundle as indexes into the certificate store. The bundle is taken
+// from the store or the certificate cache when up to date, otherwise it is parsed
+// and the store indexes are also passed to the callback as the certificates come.
+// Only the system bundles are cached on disk, other paths would each leave a file
+// in the cache directory for good.
+QVector<int> loadBundle(const QString &path, std::function<void (int)> parsed = nullptr)
+{
+    CertificateStore *store = CertificateStore::instance();
+    const bool useCache = systemBundlePaths().contains(path);
+
+    CertificateCache::Stamp stamp;
+    const bool stamped = CertificateCache::stamp(path, &stamp);
+
+    QVector<int> indexes;
+    if (stamped && store->bundle(path, stamp, &indexes)) {
+        return indexes;
+    }
+
+    QList<Certificate> certificates;
+    if (useCache && stamped && CertificateCache::load(path, stamp, &certificates)) {
+        indexes = store->insert(certificates);
+        store->setBundle(path, stamp, indexes);
+        return indexes;
+    }
+
+    // The store indexes each hold a reference, handed over to the bundle by setBundle().
+    PEMBundle bundle(path);
+    if (bundle.isValid()) {
+        QList<CertificateCache::Entry> entries;
+        bundle.for_each([&](int offset, int length) {
+            // Certificates the store already has are not decoded again.
+            const QByteArray der = bundle.der(offset, length);
+            const int known = der.isEmpty()
+                    ? -1 : store->acquire(QCryptographicHash::hash(der, QCryptographicHash::Sha256));
+
+            CertificateCache::Entry entry;
+            int index = known;
+            if (index != -1) {
+                entry.certificate = CertificatePrivate::get(store->certificate(index));
+                // The block it was first read from may be gone, whichever bundle it came from.
+                entry.certificate->relocate(path, offset, length);
+            } else {
+                entry.certificate = bundle.parse(offset, length);
+                if (!entry.certificate) {
+                    return;
+                }
+                index = store->insert(CertificatePrivate::create(entry.certificate));
+            }
+            entry.pemOffset = offset;
+            entry.pemLength = length;
+            entries.append(entry);
+            indexes.append(index);
+
+            if (parsed) {
+                parsed(index);
+            }
+        });
+
+        if (stamped && useCache) {
+            CertificateCache::store(path, stamp, entries);
+        }
+    }
+
+    // Also releases the certificates of a bundle that is gone or no longer parses.
+    store->setBundle(path, stamp, indexes);
+
+    return indexes;
+}
+
+bool isHashName(const char *name)
+{
+    // <hash>.<n> as created by c_rehash and openssl rehash, <hash>.r<n> are CRLs.
+    static const QRegularExpression hashName(QStringLiteral("^[0-9a-f]{8}\\.[0-9]+$"));
+    return hashName.match(QLatin1String(name)).hasMatch();
+}
+
+bool isCertificateName(const char *name)
+{
+    const QByteArray suffix = QByteArray(name).toLower();
+    return suffix.endsWith(".pem") || suffix.endsWith(".crt") || suffix.endsWith(".cer");
+}
+
+// Lists the certificate files of a hashed directory without opening them. Without
+// hash links the certificate files of the directory are taken instead.
+QStringList directoryFiles(const QString &path)
+{
+    QStringList hashFiles;
+    QStringList certificateFiles;
+
+    if (DIR *dir = ::opendir(QFile::encodeName(path).constData())) {
+        while (struct dirent *entry = ::readdir(dir)) {
+            if (isHashName(entry->d_name)) {
+                hashFiles.append(path + QLatin1Char('/') + QFile::decodeName(entry->d_name));
+            } else if (hashFiles.isEmpty() && isCertificateName(entry->d_name)) {
+                certificateFiles.append(path + QLatin1Char('/') + QFile::decodeName(entry->d_name));
+            }
+        }
+        ::closedir(dir);
+    }
+
+    QStringList files = hashFiles.isEmpty() ? certificateFiles : hashFiles;
+    files.sort();
+    return files;
+}
+
+bool isDirectory(const QString &path)
+{
+    struct stat st;
+    return ::stat(QFile::encodeName(path).constData(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+bool certificateLessThan(const Certificate &lhs, const Certificate &rhs)
+{
+    // The folded keys are computed once per certificate, compare them as they are.
+    const CertificatePrivate *l = CertificatePrivate::get(lhs);
+    const CertificatePrivate *r = CertificatePrivate::get(rhs);
+    int c = l->primaryKey.compare(r->primaryKey);
+    if (c < 0)
+        return true;
+    if (c > 0)
+        return false;
+    c = l->secondaryKey.compare(r->secondaryKey);
+    if (c < 0)
+        return true;
+    return false;
+}
+
+// Certificates are handed to the model in small batches so that the first
+// rows show up while the rest of the bundle is still being processed.
+const int CertificateBatchSize = 16;
+
+const QEvent::Type CertificatesParsedEvent = QEvent::Type(QEvent::User + 1);
+
+class CertificateBatchEvent : public QEvent
+{
+public:
+    CertificateBatchEvent(int generation, const QVector<int> &indexes, bool finished, bool update)
+        : QEvent(CertificatesParsedEvent), m_generation(generation), m_indexes(indexes), m_finished(finished)
+        , m_update(update)
+    {
+    }
+
+    int m_generation;
+    QVector<int> m_indexes;
+    bool m_finished;
+    bool m_update;  // The whole bundle, to be diffed against the current rows
+};
+
+class CertificateParseTask : public QRunnable
+{
+public:
+    CertificateParseTask(CertificateModel *owner, int generation, const QString &path, bool update)
+        : m_owner(owner), m_generation(generation), m_path(path), m_update(update)
+    {
+    }
+
+    void run() override
+    {
+        if (m_update) {
+            post(loadBundle(m_path), true);
+            CertificateStore::instance()->releaseUnused(m_path);
+            return;
+        }
+
+        QVector<int> batch;
+        bool parsed = false;
+        const QVector<int> indexes = loadBundle(m_path, [this, &batch, &parsed](int index) {
+            parsed = true;
+            batch.append(index);
+            if (batch.count() == CertificateBatchSize) {
+                post(batch, false);
+                batch.clear();
+            }
+        });
+
+        // A cache hit is delivered at once.
+        post(parsed ? batch : indexes, true);
+
+        // The model may be gone, or have moved on to another bundle.
+        CertificateStore::instance()->releaseUnused(m_path);
+    }
+
+private:
+    void post(const QVector<int> &indexes, bool finished)
+    {
+        if (m_owner) {
+            QCoreApplication::postEvent(m_owner, new CertificateBatchEvent(m_generation, indexes, finished, m_update));
+        }
+    }
+
+    QPointer<CertificateModel> m_owner;
+    int m_generation;
+    QString m_path;
+    bool m_update;
+};
+
+class RangeTask : public QRunnable
+{
+public:
+    RangeTask(QAtomicInt *next, int count, const std::function<void (int)> &fn)
+        : m_next(next), m_count(count), m_fn(fn)
+    {
+    }
+
+    void run() override
+    {
+        for (int i = m_next->fetchAndAddRelaxed(1); i < m_count; i = m_next->fetchAndAddRelaxed(1)) {
+            m_fn(i);
+        }
+    }
+
+private:
+    QAtomicInt *m_next;
+    int m_count;
+    std::function<void (int)> m_fn;
+};
+
+// Files of a hashed directory are parsed a batch at a time, as the view asks for more rows.
+const int CertificateFilesPerFetch = 64;
+
+const QEvent::Type DirectoryListedEvent = QEvent::Type(QEvent::User + 2);
+
+class DirectoryListingEvent : public QEvent
+{
+public:
+    DirectoryListingEvent(int generation, const QStringList &files)
+        : QEvent(DirectoryListedEvent), m_generation(generation), m_files(files)
+    {
+    }
+
+    int m_generation;
+    QStringList m_files;
+};
+
+class DirectoryListTask : public QRunnable
+{
+public:
+    DirectoryListTask(CertificateModel *owner, int generation, const QString &path)
+        : m_owner(owner), m_generation(generation), m_path(path)
+    {
+    }
+
+    void run() override
+    {
+        const QStringList files = directoryFiles(m_path);
+        CertificateStore::instance()->removeStaleBundles(m_path, files);
+        if (m_owner) {
+            QCoreApplication::postEvent(m_owner, new DirectoryListingEvent(m_generation, files));
+        }
+    }
+
+private:
+    QPointer<CertificateModel> m_owner;
+    int m_generation;
+    QString m_path;
+};
+
+class CertificateFilesTask : public QRunnable
+{
+public:
+    CertificateFilesTask(CertificateModel *owner, int generation, const QStringList &files)
+        : m_owner(owner), m_generation(generation), m_files(files)
+    {
+    }
+
+    void run() override
+    {
+        QVector<int> indexes;
+        for (const QString &file : m_files) {
+            indexes += loadBundle(file);
+        }
+
+        if (m_owner) {
+            QCoreApplication::postEvent(m_owner, new CertificateBatchEvent(m_generation, indexes, true, false));
+        }
+
+        for (const QString &file : m_files) {
+            CertificateStore::instance()->releaseUnused(file);
+        }
+    }
+
+private:
+    QPointer<CertificateModel> m_owner;
+    int m_generation;
+    QStringList m_files;
+};
+
+}
+
+QStringList systemBundlePaths()
+{
+    QStringList paths;
+    const QList<QPair<QString, CertificateModel::BundleType> > &bundles(bundlePaths());
+    for (auto it = bundles.cbegin(), end = bundles.cend(); it != end; ++it) {
+        paths.append(it->first);
+    }
+    return paths;
+}
+
+void parallelFor(int count, const std::function<void (int)> &fn)
+{
+    if (count <= 0) {
+        return;
+    }
+
+    QThreadPool pool;
+    QAtomicInt next(0);
+    for (int i = 0, n = qMin(count, pool.maxThreadCount()); i < n; ++i) {
+        pool.start(new RangeTask(&next, count, fn));
+    }
+    pool.waitForDone();
+}
+
+QString foldedKey(const QString &name)
+{
+    const QString decomposed = name.normalized(QString::NormalizationForm_KD);
+
+    QString rv;
+    rv.reserve(decomposed.length());
+    for (const QChar c : decomposed) {
+        if (c.category() != QChar::Mark_NonSpacing) {
+            rv.append(c);
+        }
+    }
+    return rv.toCaseFolded();
+}
+
+QStringList foldedWords(const QString &name)
+{
+    QStringList words;
+    const QString key = foldedKey(name);
+
+    int begin = -1;
+    for (int i = 0; i <= key.length(); ++i) {
+        const bool wordCharacter = i < key.length() && key.at(i).isLetterOrNumber();
+        if (wordCharacter && begin == -1) {
+            begin = i;
+        } else if (!wordCharacter && begin != -1) {
+            words.append(key.mid(begin, i - begin));
+            begin = -1;
+        }
+    }
+    return words;
 }
 
 Certificate::Certificate(const X509Certificate &cert)
-    : m_commonName(cert.subjectElement(NID_commonName))
-    , m_countryName(cert.subjectElement(NID_countryName))
-    , m_organizationName(cert.subjectElement(NID_organizationName))
-    , m_organizationalUnitName(cert.subjectElement(NID_organizationalUnitName))
-    , m_notValidBefore(cert.notBefore())
-    , m_notValidAfter(cert.notAfter())
+    : d(new CertificatePrivate)
+{
+    d->setCertificate(cert);
+}
+
+Certificate::Certificate(const QExplicitlySharedDataPointer<CertificatePrivate> &d)
+    : d(d)
+{
+}
+
+Certificate::Certificate(const Certificate &certificate)
+    : d(certificate.d)
+{
+}
+
+Certificate::~Certificate()
+{
+}
+
+Certificate &Certificate::operator =(const Certificate &certificate)
+{
+    d = certificate.d;
+    return *this;
+}
+
+QString Certificate::commonName() const
+{
+    return d->commonName;
+}
+
+QString Certificate::countryName() const
+{
+    return d->countryName;
+}
+
+QString Certificate::organizationName() const
+{
+    return d->organizationName;
+}
+
+QString Certificate::organizationalUnitName() const
+{
+    return d->organizationalUnitName;
+}
+
+QString Certificate::primaryName() const
+{
+    return d->primaryName;
+}
+
+QString Certificate::secondaryName() const
+{
+    return d->secondaryName;
+}
+
+QDateTime Certificate::notValidBefore() const
+{
+    return d->notValidBefore;
+}
+
+QDateTime Certificate::notValidAfter() const
+{
+    return d->notValidAfter;
+}
+
+QVariantMap Certificate::details() const
+{
+    return d->details();
+}
+
+QString Certificate::issuerDisplayName() const
+{
+    return d->issuerDisplayName;
+}
+
+QByteArray Certificate::toDer() const
 {
+    return d->der();
+}
+
+QByteArray Certificate::fingerprint() const
+{
+    return d->fingerprint;
+}
+
+void CertificatePrivate::setCertificate(const X509Certificate &cert)
+{
+    static const int subjectNids[] = { NID_commonName, NID_countryName, NID_organizationName, NID_organizationalUnitName };
+    QString subject[4];
+    cert.subjectElements(subjectNids, subject, 4);
+    commonName = subject[0];
+    countryName = subject[1];
+    organizationName = subject[2];
+    organizationalUnitName = subject[3];
+    notValidBefore = cert.notBefore();
+    notValidAfter = cert.notAfter();
+
     // Yield consistent names for the certificates, despite inconsistent naming policy
-    QString Certificate::*members[] = { &Certificate::m_commonName, &Certificate::m_organizationalUnitName, &Certificate::m_organizationName, &Certificate::m_countryName };
+    QString CertificatePrivate::*members[] = { &CertificatePrivate::commonName, &CertificatePrivate::organizationalUnitName, &CertificatePrivate::organizationName, &CertificatePrivate::countryName };
     for (auto it = std::begin(members); it != std::end(members); ++it) {
         const QString &s(this->*(*it));
         if (!s.isEmpty()) {
-            if (m_primaryName.isEmpty()) {
-                m_primaryName = s;
-            } else if (m_secondaryName.isEmpty()) {
-                m_secondaryName = s;
+            if (primaryName.isEmpty()) {
+                primaryName = s;
+            } else if (secondaryName.isEmpty()) {
+                secondaryName = s;
                 break;
             }
         }
@@ -605,70 +1209,193 @@ Certificate::Certificate(const X509Certificate &cert)
     // Returns a name that describes the issuer. It returns the CommonName if
     // available, otherwise falls back to the Organization or the first
     // OrganizationalUnitName.
-    m_issuerDisplayName = cert.issuerElement(NID_commonName);
-    if (m_issuerDisplayName.isEmpty()) {
-        m_issuerDisplayName = cert.issuerElement(NID_countryName);
+    static const int issuerNids[] = { NID_commonName, NID_countryName, NID_organizationName };
+    QString issuer[3];
+    cert.issuerElements(issuerNids, issuer, 3);
+    for (const QString &name : issuer) {
+        if (!name.isEmpty()) {
+            issuerDisplayName = name;
+            break;
+        }
+    }
+
+    const int length = i2d_X509(cert.x509, nullptr);
+    if (length > 0) {
+        encoded.resize(length);
+        unsigned char *out = reinterpret_cast<unsigned char *>(encoded.data());
+        i2d_X509(cert.x509, &out);
     }
-    if (m_issuerDisplayName.isEmpty()) {
-        m_issuerDisplayName = cert.issuerElement(NID_organizationName);
+
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int digestLength = 0;
+    if (X509_digest(cert.x509, EVP_sha256(), digest, &digestLength)) {
+        fingerprint = QByteArray(reinterpret_cast<const char *>(digest), digestLength);
     }
 
+    updateKeys();
+}
+
+void CertificatePrivate::updateKeys()
+{
+    primaryKey = foldedKey(primaryName);
+    secondaryKey = foldedKey(secondaryName);
+
+    searchWords = foldedWords(primaryName) + foldedWords(secondaryName) + foldedWords(organizationName);
+    searchWords.removeDuplicates();
+}
+
+QByteArray CertificatePrivate::der()
+{
+    QMutexLocker locker(&mutex);
+    return derLocked();
+}
+
+void CertificatePrivate::relocate(const QString &path, qint64 offset, qint64 length)
+{
+    QMutexLocker locker(&mutex);
+    pemPath = path;
+    pemOffset = offset;
+    pemLength = length;
+}
+
+QByteArray CertificatePrivate::derLocked()
+{
+    if (!encoded.isEmpty() || pemPath.isEmpty()) {
+        return encoded;
+    }
+
+    QFile file(pemPath);
+    if (!file.open(QIODevice::ReadOnly) || !file.seek(pemOffset)) {
+        qWarning() << "Unable to read certificate from:" << pemPath;
+        return encoded;
+    }
+
+    // The block of a DER file is the whole file.
+    const QByteArray pem = file.read(pemLength);
+    BIO *input = BIO_new_mem_buf(pem.constData(), pem.length());
+    if (input) {
+        X509 *x509 = pem.startsWith("-----")
+                ? PEM_read_bio_X509_AUX(input, NULL, NULL, NULL)
+                : d2i_X509_bio(input, NULL);
+        if (x509) {
+            QByteArray der;
+            const int length = i2d_X509(x509, nullptr);
+            if (length > 0) {
+                der.resize(length);
+                unsigned char *out = reinterpret_cast<unsigned char *>(der.data());
+                i2d_X509(x509, &out);
+            }
+            X509_free(x509);
+
+            // The bundle may have been rewritten since the block was located.
+            if (fingerprint.isEmpty() || QCryptographicHash::hash(der, QCryptographicHash::Sha256) == fingerprint) {
+                encoded = der;
+            } else {
+                qWarning() << "Certificate changed in:" << pemPath << "at" << pemOffset;
+            }
+        } else {
+            qWarning() << "Unable to decode certificate from:" << pemPath << "at" << pemOffset;
+        }
+        BIO_free(input);
+    }
+
+    return encoded;
+}
+
+QVariantMap CertificatePrivate::details()
+{
+    QMutexLocker locker(&mutex);
+    if (detailsResolved) {
+        return detailsCache;
+    }
+
+    const QByteArray encoding = derLocked();
+    const unsigned char *in = reinterpret_cast<const unsigned char *>(encoding.constData());
+    X509 *x509 = d2i_X509(nullptr, &in, encoding.length());
+    if (!x509) {
+        // Not cached, the bundle may be readable again on the next call.
+        qWarning() << "Unable to decode certificate:" << primaryName;
+        return QVariantMap();
+    }
+    detailsResolved = true;
+    const X509Certificate cert(x509);
+
     // Populate the details map
-    m_details.insert(QStringLiteral("Version"), QVariant(cert.version()));
-    m_details.insert(QStringLiteral("SerialNumber"), QVariant(cert.serialNumber()));
-    m_details.insert(QStringLiteral("SubjectDisplayName"), QVariant(m_primaryName));
-    m_details.insert(QStringLiteral("OrganizationName"), QVariant(m_organizationName));
-    m_details.insert(QStringLiteral("IssuerDisplayName"), QVariant(m_issuerDisplayName));
+    detailsCache.insert(QStringLiteral("Version"), QVariant(cert.version()));
+    detailsCache.insert(QStringLiteral("SerialNumber"), QVariant(cert.serialNumber()));
+    detailsCache.insert(QStringLiteral("SubjectDisplayName"), QVariant(primaryName));
+    detailsCache.insert(QStringLiteral("OrganizationName"), QVariant(organizationName));
+    detailsCache.insert(QStringLiteral("IssuerDisplayName"), QVariant(issuerDisplayName));
 
     QVariantMap validity;
-    validity.insert(QStringLiteral("NotBefore"), QVariant(cert.notBefore()));
-    validity.insert(QStringLiteral("NotAfter"), QVariant(cert.notAfter()));
-    m_details.insert(QStringLiteral("Validity"), QVariant(validity));
+    validity.insert(QStringLiteral("NotBefore"), QVariant(notValidBefore));
+    validity.insert(QStringLiteral("NotAfter"), QVariant(notValidAfter));
+    detailsCache.insert(QStringLiteral("Validity"), QVariant(validity));
 
     QVariantMap issuer;
     const QList<QPair<QString, QString>> &issuerDetails(cert.issuerList());
     for (auto it = issuerDetails.cbegin(), end = issuerDetails.cend(); it != end; ++it) {
         issuer.insert(it->first, QVariant(it->second));
     }
-    m_details.insert(QStringLiteral("Issuer"), QVariant(issuer));
+    detailsCache.insert(QStringLiteral("Issuer"), QVariant(issuer));
 
     QVariantMap subject;
     const QList<QPair<QString, QString>> &subjectDetails(cert.subjectList());
     for (auto it = subjectDetails.cbegin(), end = subjectDetails.cend(); it != end; ++it) {
         subject.insert(it->first, QVariant(it->second));
     }
-    m_details.insert(QStringLiteral("Subject"), QVariant(subject));
+    detailsCache.insert(QStringLiteral("Subject"), QVariant(subject));
 
     QVariantMap publicKey;
     const QList<QPair<QString, QString>> &keyDetails(cert.publicKeyList());
     for (auto it = keyDetails.cbegin(), end = keyDetails.cend(); it != end; ++it) {
         publicKey.insert(it->first, QVariant(it->second));
     }
-    m_details.insert(QStringLiteral("SubjectPublicKeyInfo"), QVariant(publicKey));
+    detailsCache.insert(QStringLiteral("SubjectPublicKeyInfo"), QVariant(publicKey));
 
     QVariantMap extensions;
     const QList<QPair<QString, QString>> &extensionDetails(cert.extensionList());
     for (auto it = extensionDetails.cbegin(), end = extensionDetails.cend(); it != end; ++it) {
         extensions.insert(it->first, QVariant(it->second));
     }
-    m_details.insert(QStringLiteral("Extensions"), extensions);
+    detailsCache.insert(QStringLiteral("Extensions"), extensions);
 
     QVariantMap signature;
     const QList<QPair<QString, QString>> &signatureDetails(cert.signatureList());
     for (auto it = signatureDetails.cbegin(), end = signatureDetails.cend(); it != end; ++it) {
         signature.insert(it->first, QVariant(it->second));
     }
-    m_details.insert(QStringLiteral("Signature"), signature);
+    detailsCache.insert(QStringLiteral("Signature"), signature);
+
+    X509_free(x509);
+
+    return detailsCache;
 }
 
 CertificateModel::CertificateModel(QObject *parent)
     : QAbstractListModel(parent)
     , m_type(NoBundle)
+    , m_loading(false)
+    , m_fetching(false)
+    , m_generation(0)
+    , m_watcher(new QFileSystemWatcher(this))
+    , m_updateTimer(new QTimer(this))
 {
+    // Trust store updates replace several files in a row, handle them at once.
+    m_updateTimer->setSingleShot(true);
+    m_updateTimer->setInterval(500);
+    connect(m_updateTimer, &QTimer::timeout, this, &CertificateModel::bundleChanged);
+
+    connect(m_watcher, &QFileSystemWatcher::fileChanged, m_updateTimer, static_cast<void (QTimer::*)()>(&QTimer::start));
+    // The bundle is usually replaced by a rename, which only shows in the directory.
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged, m_updateTimer, static_cast<void (QTimer::*)()>(&QTimer::start));
 }
 
 CertificateModel::~CertificateModel()
 {
+    if (!m_path.isEmpty()) {
+        CertificateStore::instance()->release(m_path);
+    }
 }
 
 CertificateModel::BundleType CertificateModel::bundleType() const
@@ -697,6 +1424,14 @@ QString CertificateModel::bundlePath() const
 void CertificateModel::setBundlePath(const QString &path)
 {
     if (m_path != path) {
+        CertificateStore *store = CertificateStore::instance();
+        if (!path.isEmpty()) {
+            store->retain(path);
+        }
+        if (!m_path.isEmpty()) {
+            store->release(m_path);
+        }
+
         m_path = path;
         refresh();
 
@@ -707,20 +1442,56 @@ void CertificateModel::setBundlePath(const QString &path)
     }
 }
 
+bool CertificateModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && !m_pendingFiles.isEmpty();
+}
+
+void CertificateModel::fetchMore(const QModelIndex &parent)
+{
+    if (parent.isValid() || m_fetching || m_pendingFiles.isEmpty()) {
+        return;
+    }
+
+    const QStringList files = m_pendingFiles.mid(0, CertificateFilesPerFetch);
+    m_pendingFiles = m_pendingFiles.mid(files.count());
+
+    m_fetching = true;
+    setLoading(true);
+    QThreadPool::globalInstance()->start(new CertificateFilesTask(this, m_generation, files));
+}
+
+bool CertificateModel::loading() const
+{
+    return m_loading;
+}
+
+void CertificateModel::setLoading(bool loading)
+{
+    if (m_loading != loading) {
+        m_loading = loading;
+        emit loadingChanged();
+    }
+}
+
 int CertificateModel::rowCount(const QModelIndex & parent) const
 {
     Q_UNUSED(parent)
-    return m_certificates.count();
+    return m_indexes.count();
 }
 
 QVariant CertificateModel::data(const QModelIndex &index, int role) const
 {
     int row = index.row();
-    if (row < 0 || row >= m_certificates.count()) {
+    if (row < 0 || row >= m_indexes.count()) {
         return QVariant();
     }
 
-    const Certificate &cert = m_certificates.at(row);
+    if (role == CertificateStoreIndexRole) {
+        return m_indexes.at(row);
+    }
+
+    const Certificate cert = CertificateStore::instance()->certificate(m_indexes.at(row));
     switch (role) {
     case CommonNameRole:
         return cert.commonName();
@@ -763,34 +1534,247 @@ QHash<int, QByteArray> CertificateModel::roleNames() const
 
     return roles;
 }
+
 void CertificateModel::refresh()
 {
+    // Results of a parse still running for the previous bundle are dropped on arrival.
+    ++m_generation;
+
     beginResetModel();
+    m_indexes.clear();
+    m_pendingFiles.clear();
+    m_fetching = false;
+    endResetModel();
+
+    watchBundle();
+
+    // Other models may have loaded the bundle already.
+    QVector<int> indexes;
     if (m_path.isEmpty()) {
-        m_certificates.clear();
+        setLoading(false);
+    } else if (isDirectory(m_path)) {
+        setLoading(true);
+        QThreadPool::globalInstance()->start(new DirectoryListTask(this, m_generation, m_path));
+    } else if (CertificateStore::instance()->bundle(m_path, &indexes)) {
+        insertCertificates(indexes);
+        setLoading(false);
     } else {
-        m_certificates = getCertificates(m_path);
-        std::stable_sort(m_certificates.begin(), m_certificates.end(), [](const Certificate &lhs, const Certificate &rhs) {
-            int c = lhs.primaryName().compare(rhs.primaryName(), Qt::CaseInsensitive);
-            if (c < 0)
-                return true;
-            if (c > 0)
-                return false;
-            c = lhs.secondaryName().compare(rhs.secondaryName(), Qt::CaseInsensitive);
-            if (c < 0)
-                return true;
-            return false;
+        setLoading(true);
+        QThreadPool::globalInstance()->start(new CertificateParseTask(this, m_generation, m_path, false));
+    }
+}
+
+void CertificateModel::watchBundle()
+{
+    m_updateTimer->stop();
+
+    const QStringList watched = m_watcher->files() + m_watcher->directories();
+    if (!watched.isEmpty()) {
+        m_watcher->removePaths(watched);
+    }
+
+    if (isDirectory(m_path)) {
+        m_watcher->addPath(m_path);
+    } else if (!m_path.isEmpty()) {
+        if (QFileInfo::exists(m_path)) {
+            m_watcher->addPath(m_path);
+        }
+        m_watcher->addPath(QFileInfo(m_path).absolutePath());
+    }
+}
+
+void CertificateModel::bundleChanged()
+{
+    if (m_path.isEmpty()) {
+        return;
+    }
+
+    // Rows of a hashed directory are not all loaded, so there is nothing to diff against.
+    if (isDirectory(m_path)) {
+        refresh();
+        return;
+    }
+
+    // A replaced file is dropped from the watcher.
+    if (!m_watcher->files().contains(m_path) && QFileInfo::exists(m_path)) {
+        m_watcher->addPath(m_path);
+    }
+
+    // Supersedes a parse still in progress, the rows are diffed against the whole bundle.
+    ++m_generation;
+    QThreadPool::globalInstance()->start(new CertificateParseTask(this, m_generation, m_path, true));
+}
+
+bool CertificateModel::event(QEvent *event)
+{
+    if (event->type() == CertificatesParsedEvent) {
+        CertificateBatchEvent *batch = static_cast<CertificateBatchEvent *>(event);
+        if (batch->m_generation == m_generation) {
+            if (batch->m_update) {
+                updateCertificates(batch->m_indexes);
+            } else {
+                insertCertificates(batch->m_indexes);
+            }
+            if (batch->m_finished) {
+                m_fetching = false;
+                setLoading(false);
+            }
+        }
+        return true;
+    } else if (event->type() == DirectoryListedEvent) {
+        DirectoryListingEvent *listing = static_cast<DirectoryListingEvent *>(event);
+        if (listing->m_generation == m_generation) {
+            m_pendingFiles = listing->m_files;
+            setLoading(false);
+            fetchMore(QModelIndex());
+        }
+        return true;
+    }
+
+    return QAbstractListModel::event(event);
+}
+
+void CertificateModel::insertCertificates(const QVector<int> &indexes)
+{
+    const CertificateStore *store = CertificateStore::instance();
+
+    if (m_indexes.isEmpty() && !indexes.isEmpty()) {
+        QList<Certificate> certificates;
+        certificates.reserve(indexes.count());
+        for (int index : indexes) {
+            certificates.append(store->certificate(index));
+        }
+        QVector<int> order(indexes.count());
+        for (int i = 0; i < order.count(); ++i) {
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(), [&certificates](int lhs, int rhs) {
+            return certificateLessThan(certificates.at(lhs), certificates.at(rhs));
+        });
+
+        beginInsertRows(QModelIndex(), 0, indexes.count() - 1);
+        for (int i : order) {
+            m_indexes.append(indexes.at(i));
+        }
+        endInsertRows();
+        return;
+    }
+
+    // Keep the rows sorted as they arrive, equal names stay in the bundle order.
+    for (int index : indexes) {
+        const Certificate certificate = store->certificate(index);
+        const auto it = std::upper_bound(m_indexes.begin(), m_indexes.end(), certificate,
+                                         [store](const Certificate &lhs, int rhs) {
+            return certificateLessThan(lhs, store->certificate(rhs));
         });
+        const int row = it - m_indexes.begin();
+
+        beginInsertRows(QModelIndex(), row, row);
+        m_indexes.insert(row, index);
+        endInsertRows();
     }
-    endResetModel();
+}
+
+void CertificateModel::updateCertificates(const QVector<int> &indexes)
+{
+    // Certificates are the same store entries across bundle updates, so the
+    // rows can be diffed by their store indexes.
+    QSet<int> current;
+    for (int index : m_indexes) {
+        current.insert(index);
+    }
+    QSet<int> updated;
+    for (int index : indexes) {
+        updated.insert(index);
+    }
+
+    for (int row = m_indexes.count() - 1; row >= 0; --row) {
+        if (updated.contains(m_indexes.at(row))) {
+            continue;
+        }
+
+        int first = row;
+        while (first > 0 && !updated.contains(m_indexes.at(first - 1))) {
+            --first;
+        }
+
+        beginRemoveRows(QModelIndex(), first, row);
+        m_indexes.remove(first, row - first + 1);
+        endRemoveRows();
+
+        row = first;
+    }
+
+    QVector<int> added;
+    for (int index : indexes) {
+        if (!current.contains(index)) {
+            added.append(index);
+        }
+    }
+    insertCertificates(added);
 }
 
 QList<Certificate> CertificateModel::getCertificates(const QString &bundlePath)
 {
-    return LibCrypto::getCertificates(bundlePath);
+    CertificateStore *store = CertificateStore::instance();
+
+    QVector<int> indexes;
+    if (isDirectory(bundlePath)) {
+        const QStringList files = directoryFiles(bundlePath);
+        store->removeStaleBundles(bundlePath, files);
+        for (const QString &file : files) {
+            indexes += loadBundle(file);
+        }
+    } else {
+        indexes = loadBundle(bundlePath);
+    }
+
+    // The certificates returned stay valid, the bundle is kept only if a model uses it.
+    const QList<Certificate> certificates = store->certificates(indexes);
+    store->releaseUnused(bundlePath);
+    return certificates;
 }
 
 QList<Certificate> CertificateModel::getCertificates(const QByteArray &pem)
 {
-    return LibCrypto::getCertificates(pem);
+    // Certificates already known to the store are shared rather than duplicated, the
+    // others are not added as no bundle refers to them.
+    const CertificateStore *store = CertificateStore::instance();
+    QList<Certificate> certificates = LibCrypto::getCertificates(pem);
+    for (Certificate &certificate : certificates) {
+        certificate = store->shared(certificate);
+    }
+    return certificates;
+}
+
+QList<Certificate> CertificateModel::importCertificates(const QList<QByteArray> &pemBlobs)
+{
+    QVector<QList<Certificate>> parsed(pemBlobs.count());
+    QList<Certificate> *out = parsed.data();
+    parallelFor(pemBlobs.count(), [&pemBlobs, out](int i) {
+        out[i] = LibCrypto::getCertificates(pemBlobs.at(i));
+    });
+
+    CertificateStore *store = CertificateStore::instance();
+    QSet<QByteArray> known;
+    const QStringList paths = systemBundlePaths();
+    for (const QString &path : paths) {
+        const QList<Certificate> certificates = store->certificates(loadBundle(path));
+        for (const Certificate &certificate : certificates) {
+            known.insert(certificate.fingerprint());
+        }
+    }
+
+    // Also drops the duplicates within the imported blobs.
+    QList<Certificate> rv;
+    for (const QList<Certificate> &certificates : parsed) {
+        for (const Certificate &certificate : certificates) {
+            if (!known.contains(certificate.fingerprint())) {
+                known.insert(certificate.fingerprint());
+                rv.append(certificate);
+            }
+        }
+    }
+
+    return rv;
 }
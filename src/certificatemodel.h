@@ -35,47 +35,54 @@
 
 #include <QAbstractListModel>
 #include <QDateTime>
+#include <QExplicitlySharedDataPointer>
 #include <QList>
+#include <QStringList>
+#include <QVector>
 #include <QVariantMap>
 
 #include "systemsettingsglobal.h"
 
+class QFileSystemWatcher;
+class QTimer;
+
 
 struct X509Certificate;
+class CertificatePrivate;
 
 class SYSTEMSETTINGS_EXPORT Certificate
 {
 public:
     Certificate(const X509Certificate &cert);
+    Certificate(const Certificate &certificate);
+    ~Certificate();
 
-    QString commonName() const { return m_commonName; }
-    QString countryName() const { return m_countryName; }
-    QString organizationName() const { return m_organizationName; }
-    QString organizationalUnitName() const { return m_organizationalUnitName; }
-    QString primaryName() const { return m_primaryName; }
-    QString secondaryName() const { return m_secondaryName; }
+    Certificate &operator =(const Certificate &certificate);
 
-    QDateTime notValidBefore() const { return m_notValidBefore; }
-    QDateTime notValidAfter() const { return m_notValidAfter; }
+    QString commonName() const;
+    QString countryName() const;
+    QString organizationName() const;
+    QString organizationalUnitName() const;
+    QString primaryName() const;
+    QString secondaryName() const;
 
-    QVariantMap details() const { return m_details; }
+    QDateTime notValidBefore() const;
+    QDateTime notValidAfter() const;
 
-    QString issuerDisplayName() const { return m_issuerDisplayName; }
+    // Decoded from the DER encoding on the first call.
+    QVariantMap details() const;
 
-private:
-    QString m_commonName;
-    QString m_countryName;
-    QString m_organizationName;
-    QString m_organizationalUnitName;
-    QString m_primaryName;
-    QString m_secondaryName;
+    QString issuerDisplayName() const;
 
-    QDateTime m_notValidBefore;
-    QDateTime m_notValidAfter;
+    QByteArray toDer() const;
+    QByteArray fingerprint() const;
+
+private:
+    friend class CertificatePrivate;
 
-    QString m_issuerDisplayName;
+    explicit Certificate(const QExplicitlySharedDataPointer<CertificatePrivate> &d);
 
-    QVariantMap m_details;
+    QExplicitlySharedDataPointer<CertificatePrivate> d;
 };
 
 class SYSTEMSETTINGS_EXPORT CertificateModel: public QAbstractListModel
@@ -83,6 +90,7 @@ class SYSTEMSETTINGS_EXPORT CertificateModel: public QAbstractListModel
     Q_OBJECT
     Q_PROPERTY(BundleType bundleType READ bundleType WRITE setBundleType NOTIFY bundleTypeChanged)
     Q_PROPERTY(QString bundlePath READ bundlePath WRITE setBundlePath NOTIFY bundlePathChanged)
+    Q_PROPERTY(bool loading READ loading NOTIFY loadingChanged)
     Q_ENUMS(BundleType)
 
 public:
@@ -115,25 +123,51 @@ public:
     QString bundlePath() const;
     void setBundlePath(const QString &path);
 
+    bool loading() const;
+
     virtual int rowCount(const QModelIndex & parent = QModelIndex()) const;
     virtual QVariant data(const QModelIndex &index, int role) const;
 
+    // A hashed certificate directory is loaded a batch of files at a time.
+    virtual bool canFetchMore(const QModelIndex &parent) const;
+    virtual void fetchMore(const QModelIndex &parent);
+
+    // The path may also be a hashed certificate directory.
     static QList<Certificate> getCertificates(const QString &bundlePath);
     static QList<Certificate> getCertificates(const QByteArray &pem);
 
+    // Parses the PEM blobs in parallel and returns the certificates not present
+    // in the system bundles, each once. Details are decoded when first asked for.
+    static QList<Certificate> importCertificates(const QList<QByteArray> &pemBlobs);
+
 Q_SIGNALS:
     void bundleTypeChanged();
     void bundlePathChanged();
+    void loadingChanged();
 
 protected:
     void refresh();
 
     QHash<int, QByteArray> roleNames() const;
+    bool event(QEvent *event);
 
 private:
+    void insertCertificates(const QVector<int> &indexes);
+    void updateCertificates(const QVector<int> &indexes);
+    void watchBundle();
+    void bundleChanged();
+    void setLoading(bool loading);
+
     BundleType m_type;
     QString m_path;
-    QList<Certificate> m_certificates;
+    // Indexes into the process wide certificate store, in the row order.
+    QVector<int> m_indexes;
+    bool m_loading;
+    bool m_fetching;
+    int m_generation;
+    QStringList m_pendingFiles;
+    QFileSystemWatcher *m_watcher;
+    QTimer *m_updateTimer;
 };
 
 #endif
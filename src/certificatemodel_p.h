@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2026 Nemo Mobile Project
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#ifndef CERTIFICATEMODEL_P_H
+#define CERTIFICATEMODEL_P_H
+
+#include "certificatemodel.h"
+
+#include <QByteArray>
+#include <QMutex>
+#include <QSharedData>
+#include <QStringList>
+
+#include <functional>
+
+// The TLS, email and object signing bundles of the system trust store.
+QStringList systemBundlePaths();
+
+// Case and accent folded form of a name, for sorting and searching.
+QString foldedKey(const QString &name);
+// Folded words of a name or a search string.
+QStringList foldedWords(const QString &name);
+
+// CertificateModel role of the certificate store index of a row, not listed in the role names.
+const int CertificateStoreIndexRole = CertificateModel::DetailsRole + 0x100;
+
+// Calls fn for each index below count on the threads of a pool, and returns when all are done.
+void parallelFor(int count, const std::function<void (int)> &fn);
+
+class CertificatePrivate : public QSharedData
+{
+public:
+    CertificatePrivate()
+        : pemOffset(-1)
+        , pemLength(-1)
+        , detailsResolved(false)
+    {
+    }
+
+    static Certificate create(const QExplicitlySharedDataPointer<CertificatePrivate> &d) { return Certificate(d); }
+    static CertificatePrivate *get(const Certificate &certificate) { return certificate.d.data(); }
+
+    void setCertificate(const X509Certificate &cert);
+    // Computes the folded keys from the names.
+    void updateKeys();
+
+    // Reads the PEM block back from the bundle if the certificate came from the cache.
+    QByteArray der();
+    // Points the certificate at the copy in the bundle loaded last, the previous
+    // bundle may have been rewritten since.
+    void relocate(const QString &path, qint64 offset, qint64 length);
+
+    // Decodes the DER on first use, the result is kept for the later calls.
+    QVariantMap details();
+
+    QString commonName;
+    QString countryName;
+    QString organizationName;
+    QString organizationalUnitName;
+    QString primaryName;
+    QString secondaryName;
+
+    QDateTime notValidBefore;
+    QDateTime notValidAfter;
+
+    QString issuerDisplayName;
+
+    QString primaryKey;
+    QString secondaryKey;
+    // Folded words of the primary, secondary and organization names.
+    QStringList searchWords;
+
+    // SHA-256 of the DER encoding.
+    QByteArray fingerprint;
+
+    // Location of the PEM block in the bundle file, or the whole file when DER encoded.
+    // Changed only by relocate() once shared.
+    QString pemPath;
+    qint64 pemOffset;
+    qint64 pemLength;
+
+private:
+    QByteArray derLocked();
+
+    QMutex mutex;
+    QByteArray encoded;
+    bool detailsResolved;
+    QVariantMap detailsCache;
+};
+
+#endif
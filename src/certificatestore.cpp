@@ -0,0 +1,336 @@
+/*
+ * Copyright (C) 2026 Nemo Mobile Project
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include "certificatestore_p.h"
+#include "certificatemodel_p.h"
+
+#include <algorithm>
+
+CertificateStore *CertificateStore::instance()
+{
+    static CertificateStore store;
+    return &store;
+}
+
+bool CertificateStore::bundle(const QString &bundlePath, QVector<int> *indexes) const
+{
+    CertificateCache::Stamp stamp;
+    return CertificateCache::stamp(bundlePath, &stamp) && bundle(bundlePath, stamp, indexes);
+}
+
+bool CertificateStore::bundle(const QString &bundlePath, const CertificateCache::Stamp &stamp, QVector<int> *indexes) const
+{
+    QMutexLocker locker(&m_mutex);
+
+    auto it = m_bundles.constFind(bundlePath);
+    if (it == m_bundles.constEnd() || !(it->stamp == stamp)) {
+        return false;
+    }
+
+    *indexes = it->indexes;
+    return true;
+}
+
+void CertificateStore::setBundle(const QString &bundlePath, const CertificateCache::Stamp &stamp, const QVector<int> &indexes)
+{
+    QMutexLocker locker(&m_mutex);
+
+    QVector<int> released;
+    auto it = m_bundles.find(bundlePath);
+    if (it != m_bundles.end()) {
+        released = it->indexes;
+    }
+
+    // A removed file, e.g. a dropped hash link, takes its certificates along.
+    if (indexes.isEmpty()) {
+        if (it != m_bundles.end()) {
+            m_bundles.erase(it);
+        }
+    } else {
+        Bundle &bundle = m_bundles[bundlePath];
+        bundle.stamp = stamp;
+        bundle.indexes = indexes;
+    }
+
+    releaseLocked(released);
+}
+
+void CertificateStore::removeStaleBundles(const QString &directoryPath, const QStringList &filePaths)
+{
+    QMutexLocker locker(&m_mutex);
+
+    QSet<QString> listed;
+    for (const QString &filePath : filePaths) {
+        listed.insert(filePath);
+    }
+
+    const QString prefix = directoryPath + QLatin1Char('/');
+    QVector<int> released;
+    for (auto it = m_bundles.begin(); it != m_bundles.end();) {
+        if (it.key().startsWith(prefix) && it.key().indexOf(QLatin1Char('/'), prefix.length()) == -1
+                && !listed.contains(it.key())) {
+            released += it->indexes;
+            it = m_bundles.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    releaseLocked(released);
+}
+
+void CertificateStore::retain(const QString &path)
+{
+    QMutexLocker locker(&m_mutex);
+    ++m_users[path];
+}
+
+void CertificateStore::release(const QString &path)
+{
+    QMutexLocker locker(&m_mutex);
+
+    auto it = m_users.find(path);
+    if (it == m_users.end()) {
+        return;
+    }
+    if (--*it == 0) {
+        m_users.erase(it);
+        releaseUnusedLocked(path);
+    }
+}
+
+void CertificateStore::releaseUnused(const QString &path)
+{
+    QMutexLocker locker(&m_mutex);
+    releaseUnusedLocked(path);
+}
+
+bool CertificateStore::isUsedLocked(const QString &bundlePath) const
+{
+    // Read by most processes and cached on disk, so not worth loading again.
+    static const QStringList systemPaths = systemBundlePaths();
+
+    // Files of a hashed directory are used by the models of the directory.
+    return m_users.contains(bundlePath)
+            || m_users.contains(bundlePath.left(bundlePath.lastIndexOf(QLatin1Char('/'))))
+            || systemPaths.contains(bundlePath);
+}
+
+void CertificateStore::releaseUnusedLocked(const QString &path)
+{
+    const QString prefix = path + QLatin1Char('/');
+    QVector<int> released;
+    for (auto it = m_bundles.begin(); it != m_bundles.end();) {
+        const bool inPath = it.key() == path
+                || (it.key().startsWith(prefix) && it.key().indexOf(QLatin1Char('/'), prefix.length()) == -1);
+        if (inPath && !isUsedLocked(it.key())) {
+            released += it->indexes;
+            it = m_bundles.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    releaseLocked(released);
+}
+
+int CertificateStore::insert(const Certificate &certificate)
+{
+    QMutexLocker locker(&m_mutex);
+    return insertLocked(certificate);
+}
+
+QVector<int> CertificateStore::insert(const QList<Certificate> &certificates)
+{
+    QMutexLocker locker(&m_mutex);
+
+    QVector<int> indexes;
+    indexes.reserve(certificates.count());
+    for (const Certificate &certificate : certificates) {
+        indexes.append(insertLocked(certificate));
+    }
+    return indexes;
+}
+
+int CertificateStore::insertLocked(const Certificate &certificate)
+{
+    const QByteArray fingerprint = certificate.fingerprint();
+
+    if (!fingerprint.isEmpty()) {
+        auto it = m_fingerprints.constFind(fingerprint);
+        if (it != m_fingerprints.constEnd()) {
+            // Read from a cache just validated against its bundle, so the location is current.
+            const CertificatePrivate *d = CertificatePrivate::get(certificate);
+            CertificatePrivate *stored = CertificatePrivate::get(m_certificates.at(*it));
+            if (d != stored && !d->pemPath.isEmpty()) {
+                stored->relocate(d->pemPath, d->pemOffset, d->pemLength);
+            }
+            ++m_references[*it];
+            return *it;
+        }
+    }
+
+    const int index = m_certificates.count();
+    m_certificates.append(certificate);
+    m_references.append(1);
+    if (!fingerprint.isEmpty()) {
+        m_fingerprints.insert(fingerprint, index);
+    }
+    return index;
+}
+
+int CertificateStore::acquire(const QByteArray &fingerprint)
+{
+    QMutexLocker locker(&m_mutex);
+
+    auto it = m_fingerprints.constFind(fingerprint);
+    if (it == m_fingerprints.constEnd()) {
+        return -1;
+    }
+    ++m_references[*it];
+    return *it;
+}
+
+void CertificateStore::releaseLocked(const QVector<int> &indexes)
+{
+    static const Certificate dropped = CertificatePrivate::create(
+                QExplicitlySharedDataPointer<CertificatePrivate>(new CertificatePrivate));
+
+    QSet<int> evicted;
+    for (int index : indexes) {
+        if (--m_references[index] == 0) {
+            m_fingerprints.remove(m_certificates.at(index).fingerprint());
+            m_certificates[index] = dropped;
+            evicted.insert(index);
+        }
+    }
+
+    if (!evicted.isEmpty()) {
+        m_searchIndex.erase(std::remove_if(m_searchIndex.begin(), m_searchIndex.end(),
+                                           [&evicted](const QPair<QString, int> &entry) {
+            return evicted.contains(entry.second);
+        }), m_searchIndex.end());
+    }
+}
+
+Certificate CertificateStore::shared(const Certificate &certificate) const
+{
+    QMutexLocker locker(&m_mutex);
+
+    auto it = m_fingerprints.constFind(certificate.fingerprint());
+    return it != m_fingerprints.constEnd() ? m_certificates.at(*it) : certificate;
+}
+
+Certificate CertificateStore::certificate(int index) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_certificates.at(index);
+}
+
+QList<Certificate> CertificateStore::certificates(const QVector<int> &indexes) const
+{
+    QMutexLocker locker(&m_mutex);
+
+    // Certificates dropped since the indexes were taken are left out.
+    QList<Certificate> rv;
+    rv.reserve(indexes.count());
+    for (int index : indexes) {
+        if (m_references.at(index) > 0) {
+            rv.append(m_certificates.at(index));
+        }
+    }
+    return rv;
+}
+
+QSet<int> CertificateStore::search(const QStringList &words, int *searched) const
+{
+    QMutexLocker locker(&m_mutex);
+
+    updateSearchIndexLocked();
+    *searched = m_searchIndexed;
+
+    QSet<int> rv;
+    for (int i = 0; i < words.count(); ++i) {
+        const QString &word = words.at(i);
+
+        QSet<int> matches;
+        auto it = std::lower_bound(m_searchIndex.constBegin(), m_searchIndex.constEnd(), word,
+                                   [](const QPair<QString, int> &entry, const QString &word) {
+            return entry.first < word;
+        });
+        for (; it != m_searchIndex.constEnd() && it->first.startsWith(word); ++it) {
+            matches.insert(it->second);
+        }
+
+        if (i == 0) {
+            rv = matches;
+        } else {
+            rv.intersect(matches);
+        }
+        if (rv.isEmpty()) {
+            break;
+        }
+    }
+    return rv;
+}
+
+bool CertificateStore::matches(const Certificate &certificate, const QStringList &words)
+{
+    const QStringList &searchWords = CertificatePrivate::get(certificate)->searchWords;
+    for (const QString &word : words) {
+        bool found = false;
+        for (const QString &searchWord : searchWords) {
+            if (searchWord.startsWith(word)) {
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void CertificateStore::updateSearchIndexLocked() const
+{
+    if (m_searchIndexed == m_certificates.count()) {
+        return;
+    }
+
+    for (; m_searchIndexed < m_certificates.count(); ++m_searchIndexed) {
+        const QStringList &words = CertificatePrivate::get(m_certificates.at(m_searchIndexed))->searchWords;
+        for (const QString &word : words) {
+            m_searchIndex.append(qMakePair(word, m_searchIndexed));
+        }
+    }
+    std::sort(m_searchIndex.begin(), m_searchIndex.end());
+}
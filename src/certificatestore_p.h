@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2026 Nemo Mobile Project
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#ifndef CERTIFICATESTORE_P_H
+#define CERTIFICATESTORE_P_H
+
+#include <QHash>
+#include <QMutex>
+#include <QPair>
+#include <QSet>
+#include <QStringList>
+#include <QVector>
+
+#include "certificatecache_p.h"
+#include "certificatemodel.h"
+
+// Process wide set of certificates keyed by their SHA-256 fingerprint. A
+// certificate is held once however many bundles contain it, and bundles
+// are lists of indexes into the store.
+//
+// Certificates are counted by the bundles referring to them and dropped with
+// the last one. Indexes are not reused, a dropped index reads as an empty
+// certificate until the models holding it have caught up with the bundle.
+//
+// Bundles are kept while a model uses them, the system bundles for good.
+// Other bundles are dropped by releaseUnused() once the caller is done.
+class CertificateStore
+{
+public:
+    static CertificateStore *instance();
+
+    // Returns the indexes of a previously loaded bundle if the bundle file has not changed since.
+    bool bundle(const QString &bundlePath, QVector<int> *indexes) const;
+    bool bundle(const QString &bundlePath, const CertificateCache::Stamp &stamp, QVector<int> *indexes) const;
+    // Takes over the references of the indexes and releases those of the bundle replaced.
+    void setBundle(const QString &bundlePath, const CertificateCache::Stamp &stamp, const QVector<int> &indexes);
+    // Drops the bundles of the files of a hashed directory that are no longer listed.
+    void removeStaleBundles(const QString &directoryPath, const QStringList &filePaths);
+
+    // Counts the models using a bundle file or a hashed directory.
+    void retain(const QString &path);
+    void release(const QString &path);
+    // Drops the bundle, or the bundles of the files of a directory, unless still used.
+    void releaseUnused(const QString &path);
+
+    // Adds the certificate unless there already is one with the same fingerprint, and
+    // returns its index with a reference held for setBundle().
+    int insert(const Certificate &certificate);
+    QVector<int> insert(const QList<Certificate> &certificates);
+    // Returns the index of the certificate with a reference held for setBundle(), or -1.
+    int acquire(const QByteArray &fingerprint);
+
+    // Returns the stored certificate with the same fingerprint, or the certificate itself.
+    Certificate shared(const Certificate &certificate) const;
+
+    Certificate certificate(int index) const;
+    QList<Certificate> certificates(const QVector<int> &indexes) const;
+
+    // Returns the indexes of the certificates having, for each of the folded words,
+    // a search word starting with it. Indexes from searched on were not searched,
+    // being added after the call.
+    QSet<int> search(const QStringList &words, int *searched) const;
+    static bool matches(const Certificate &certificate, const QStringList &words);
+
+private:
+    struct Bundle
+    {
+        CertificateCache::Stamp stamp;
+        QVector<int> indexes;
+    };
+
+    bool isUsedLocked(const QString &bundlePath) const;
+    void releaseUnusedLocked(const QString &path);
+    int insertLocked(const Certificate &certificate);
+    void releaseLocked(const QVector<int> &indexes);
+    void updateSearchIndexLocked() const;
+
+    mutable QMutex m_mutex;
+    QVector<Certificate> m_certificates;
+    QVector<int> m_references;
+    QHash<QByteArray, int> m_fingerprints;
+    QHash<QString, Bundle> m_bundles;
+    QHash<QString, int> m_users;
+
+    // Search words of all certificates with their store index, sorted by the word.
+    mutable QVector<QPair<QString, int>> m_searchIndex;
+    mutable int m_searchIndexed = 0;
+};
+
+#endif
@@ -0,0 +1,237 @@
+/*
+ * Copyright (C) 2026 Nemo Mobile Project
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include "directorysize_p.h"
+
+#include <QFile>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const int DirectoryFlags = O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC;
+
+qint64 nanoseconds(const struct timespec &time)
+{
+    return qint64(time.tv_sec) * 1000000000LL + time.tv_nsec;
+}
+
+bool isDotOrDotDot(const char *name)
+{
+    return name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'));
+}
+
+// fdopendir() takes the ownership of the descriptor, keep the original one for *at() calls.
+DIR *openDirectoryStream(int fd)
+{
+    const int streamFd = ::dup(fd);
+    if (streamFd < 0) {
+        return nullptr;
+    }
+
+    DIR *dir = ::fdopendir(streamFd);
+    if (!dir) {
+        ::close(streamFd);
+    }
+    return dir;
+}
+
+}
+
+DirectorySizeCache::DirectorySizeCache()
+{
+}
+
+DirectorySizeCache::~DirectorySizeCache()
+{
+}
+
+quint64 DirectorySizeCache::size(const QString &path)
+{
+    const QByteArray encodedPath = QFile::encodeName(path);
+
+    struct stat st;
+    if (::stat(encodedPath.constData(), &st) != 0 || !S_ISDIR(st.st_mode)) {
+        invalidate(path);
+        return 0;
+    }
+
+    return walk(AT_FDCWD, encodedPath, encodedPath, st.st_dev);
+}
+
+quint64 DirectorySizeCache::removeContents(const QString &path)
+{
+    const quint64 bytesBefore = size(path);
+
+    const QByteArray encodedPath = QFile::encodeName(path);
+    const int fd = ::open(encodedPath.constData(), DirectoryFlags);
+    if (fd >= 0) {
+        removeTree(fd);
+        ::close(fd);
+    }
+
+    invalidate(path);
+
+    const quint64 bytesAfter = size(path);
+    return bytesBefore > bytesAfter ? bytesBefore - bytesAfter : 0;
+}
+
+void DirectorySizeCache::invalidate(const QString &path)
+{
+    const QByteArray encodedPath = QFile::encodeName(path);
+    const QByteArray prefix = encodedPath + '/';
+
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (it.key() == encodedPath || it.key().startsWith(prefix)) {
+            it = m_entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void DirectorySizeCache::clear()
+{
+    m_entries.clear();
+}
+
+quint64 DirectorySizeCache::walk(int parentFd, const QByteArray &name, const QByteArray &path, dev_t device)
+{
+    const int fd = ::openat(parentFd, name.constData(), DirectoryFlags);
+    if (fd < 0) {
+        m_entries.remove(path);
+        return 0;
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_dev != device) {
+        ::close(fd);
+        return 0;
+    }
+
+    auto it = m_entries.find(path);
+    if (it == m_entries.end()
+            || it->modified != nanoseconds(st.st_mtim)
+            || it->changed != nanoseconds(st.st_ctim)) {
+        Entry entry;
+        entry.modified = nanoseconds(st.st_mtim);
+        entry.changed = nanoseconds(st.st_ctim);
+
+        if (DIR *dir = openDirectoryStream(fd)) {
+            while (struct dirent *directoryEntry = ::readdir(dir)) {
+                if (isDotOrDotDot(directoryEntry->d_name)) {
+                    continue;
+                }
+
+                struct stat entryStat;
+                if (::fstatat(fd, directoryEntry->d_name, &entryStat, AT_SYMLINK_NOFOLLOW) != 0) {
+                    continue;
+                }
+
+                if (!S_ISDIR(entryStat.st_mode)) {
+                    entry.fileBytes += quint64(entryStat.st_blocks) * 512;
+                } else if (entryStat.st_dev == device) {
+                    entry.subdirectories.append(QByteArray(directoryEntry->d_name));
+                }
+            }
+            ::closedir(dir);
+        }
+
+        if (it != m_entries.end()) {
+            // Forget subdirectories that are gone.
+            const QVector<QByteArray> previousSubdirectories = it->subdirectories;
+            for (const QByteArray &subdirectory : previousSubdirectories) {
+                if (!entry.subdirectories.contains(subdirectory)) {
+                    invalidate(QFile::decodeName(path + '/' + subdirectory));
+                }
+            }
+        }
+
+        it = m_entries.insert(path, entry);
+    }
+
+    quint64 bytes = quint64(st.st_blocks) * 512 + it->fileBytes;
+
+    // Recursion inserts to m_entries, don't hold on to the iterator.
+    const QVector<QByteArray> subdirectories = it->subdirectories;
+    for (const QByteArray &subdirectory : subdirectories) {
+        bytes += walk(fd, subdirectory, path + '/' + subdirectory, device);
+    }
+
+    ::close(fd);
+
+    return bytes;
+}
+
+void DirectorySizeCache::removeTree(int dirFd)
+{
+    struct stat st;
+    if (::fstat(dirFd, &st) != 0) {
+        return;
+    }
+
+    DIR *dir = openDirectoryStream(dirFd);
+    if (!dir) {
+        return;
+    }
+
+    while (struct dirent *directoryEntry = ::readdir(dir)) {
+        if (isDotOrDotDot(directoryEntry->d_name)) {
+            continue;
+        }
+
+        struct stat entryStat;
+        if (::fstatat(dirFd, directoryEntry->d_name, &entryStat, AT_SYMLINK_NOFOLLOW) != 0) {
+            continue;
+        }
+
+        if (S_ISDIR(entryStat.st_mode)) {
+            // Never descend to other file systems mounted below the removed tree.
+            if (entryStat.st_dev != st.st_dev) {
+                continue;
+            }
+
+            const int childFd = ::openat(dirFd, directoryEntry->d_name, DirectoryFlags);
+            if (childFd >= 0) {
+                removeTree(childFd);
+                ::close(childFd);
+            }
+            ::unlinkat(dirFd, directoryEntry->d_name, AT_REMOVEDIR);
+        } else {
+            ::unlinkat(dirFd, directoryEntry->d_name, 0);
+        }
+    }
+
+    ::closedir(dir);
+}
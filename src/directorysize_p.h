@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2026 Nemo Mobile Project
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#ifndef DIRECTORYSIZE_P_H
+#define DIRECTORYSIZE_P_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+#include <sys/types.h>
+
+// Sums up the disk usage of directory trees without spawning du(1).
+//
+// The direct file usage of every visited directory is remembered together with the
+// modification and change times of the directory. As long as those are unchanged the
+// directory entries are not read again on the next walk, only the subdirectories are
+// descended into. Files that are rewritten in place without touching their directory
+// are thus only noticed once the directory itself changes, which is good enough for
+// caches as they are usually replaced instead of appended to.
+//
+// Not thread safe, each instance is expected to be owned by a single worker thread.
+class DirectorySizeCache
+{
+public:
+    DirectorySizeCache();
+    ~DirectorySizeCache();
+
+    // Bytes allocated for the tree below path, not crossing file system boundaries.
+    quint64 size(const QString &path);
+
+    // Removes everything below path while keeping path itself. Returns the bytes freed.
+    quint64 removeContents(const QString &path);
+
+    void invalidate(const QString &path);
+    void clear();
+
+private:
+    struct Entry
+    {
+        qint64 modified = 0;
+        qint64 changed = 0;
+        quint64 fileBytes = 0;
+        QVector<QByteArray> subdirectories;
+    };
+
+    quint64 walk(int parentFd, const QByteArray &name, const QByteArray &path, dev_t device);
+    void removeTree(int dirFd);
+
+    QHash<QByteArray, Entry> m_entries;
+};
+
+#endif
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2026 Nemo Mobile Project
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include "diskquota_p.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+
+#include <linux/limits.h>
+#include <mntent.h>
+#include <sys/quota.h>
+
+namespace {
+
+QMutex probeMutex;
+QHash<QString, bool> probedDevices;
+
+}
+
+QString DiskQuota::devicePath(const QString &path)
+{
+    QString devicePath;
+    int matchLength = -1;
+
+    FILE *mounts = setmntent("/proc/self/mounts", "r");
+    if (!mounts) {
+        return devicePath;
+    }
+
+    mntent mountEntry;
+    char buffer[3 * PATH_MAX];
+    while (getmntent_r(mounts, &mountEntry, buffer, sizeof(buffer))) {
+        const QString mountPath = QString::fromUtf8(mountEntry.mnt_dir);
+        const bool covers = path == mountPath
+                || mountPath == QLatin1String("/")
+                || path.startsWith(mountPath + QLatin1Char('/'));
+        // Later entries shadow earlier ones on the same path.
+        if (covers && mountPath.length() >= matchLength) {
+            matchLength = mountPath.length();
+            devicePath = QString::fromUtf8(mountEntry.mnt_fsname);
+        }
+    }
+
+    endmntent(mounts);
+
+    return devicePath;
+}
+
+bool DiskQuota::isEnabled(const QString &devicePath)
+{
+    QMutexLocker locker(&probeMutex);
+
+    auto it = probedDevices.constFind(devicePath);
+    if (it == probedDevices.constEnd()) {
+        struct if_dqinfo info = {};
+        const bool enabled = ::quotactl(QCMD(Q_GETINFO, USRQUOTA), devicePath.toUtf8().constData(),
+                                        0, reinterpret_cast<caddr_t>(&info)) == 0;
+        it = probedDevices.insert(devicePath, enabled);
+    }
+
+    return *it;
+}
+
+bool DiskQuota::usage(const QString &devicePath, uid_t uid, Usage *usage)
+{
+    if (!isEnabled(devicePath)) {
+        return false;
+    }
+
+    struct if_dqblk quota = {};
+    if (::quotactl(QCMD(Q_GETQUOTA, USRQUOTA), devicePath.toUtf8().constData(),
+                   uid, reinterpret_cast<caddr_t>(&quota)) != 0) {
+        return false;
+    }
+
+    usage->bytesUsed = static_cast<qint64>(quota.dqb_curspace);
+    usage->bytesLimit = static_cast<qint64>(dbtob(quota.dqb_bsoftlimit));
+    return true;
+}
@@ -0,0 +1,220 @@
+/*
+ * Copyright (C) 2026 Nemo Mobile Project
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include "iostatssampler_p.h"
+#include "partition_p.h"
+#include "sysfsblock_p.h"
+#include "logging_p.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QSet>
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+namespace {
+
+// Rates are averaged over the samples of the last few seconds.
+const int WindowSize = 5;
+
+const quint64 SectorSize = 512;
+
+}
+
+IoStatsSampler::IoStatsSampler()
+{
+}
+
+IoStatsSampler::~IoStatsSampler()
+{
+    clear();
+}
+
+IoStatsSampler::PartitionList IoStatsSampler::sample(const PartitionList &partitions)
+{
+    static QElapsedTimer clock;
+    if (!clock.isValid()) {
+        clock.start();
+    }
+
+    PartitionList changedPartitions;
+    QSet<QString> sampledDevices;
+
+    for (const auto &partition : partitions) {
+        if (partition->status != Partition::Mounted || !partition->devicePath.startsWith(QLatin1String("/dev/"))) {
+            // Once unmounted the last rates would otherwise be reported for good.
+            if (partition->readBytesPerSecond > 0 || partition->writeBytesPerSecond > 0
+                    || partition->readOperationsPerSecond > 0 || partition->writeOperationsPerSecond > 0
+                    || partition->requestsInFlight > 0 || partition->utilization > 0) {
+                partition->readBytesPerSecond = 0;
+                partition->writeBytesPerSecond = 0;
+                partition->readOperationsPerSecond = 0;
+                partition->writeOperationsPerSecond = 0;
+                partition->requestsInFlight = 0;
+                partition->utilization = 0;
+                changedPartitions.append(partition);
+            }
+            continue;
+        }
+
+        // Statistics of the mapped device reflect the file system, not the encrypted backing partition.
+        const QString name = SysfsBlock::kernelName(partition->devicePath, false);
+        if (name.isEmpty()) {
+            continue;
+        }
+
+        Device &device = m_devices[name];
+        if (device.fd < 0) {
+            const QByteArray path = QFile::encodeName(QStringLiteral("/sys/class/block/") + name + QStringLiteral("/stat"));
+            device.fd = ::open(path.constData(), O_RDONLY | O_CLOEXEC);
+            if (device.fd < 0) {
+                qCWarning(lcMemoryCardLog) << "Cannot open I/O statistics of" << name;
+                m_devices.remove(name);
+                continue;
+            }
+        }
+
+        // Several partitions may resolve to the same device, e.g. / and /home on one LVM volume.
+        if (!sampledDevices.contains(name)) {
+            sampledDevices.insert(name);
+
+            Sample sample;
+            if (!read(device.fd, &sample)) {
+                continue;
+            }
+            sample.time = clock.elapsed();
+
+            if (!device.window.isEmpty()) {
+                const Sample &last = device.window.last();
+                // Counters going backwards mean a different device got the same name.
+                if (sample.readSectors < last.readSectors || sample.writeSectors < last.writeSectors) {
+                    device.window.clear();
+                }
+            }
+
+            device.window.append(sample);
+            if (device.window.count() > WindowSize + 1) {
+                device.window.removeFirst();
+            }
+        }
+
+        if (device.window.isEmpty()) {
+            continue;
+        }
+        const Sample &current = device.window.last();
+
+        qint64 readBytesPerSecond = 0;
+        qint64 writeBytesPerSecond = 0;
+        qreal readOperationsPerSecond = 0;
+        qreal writeOperationsPerSecond = 0;
+        qreal utilization = 0;
+
+        const Sample &first = device.window.first();
+        const qint64 elapsed = current.time - first.time;
+        if (elapsed > 0) {
+            const qreal seconds = elapsed / 1000.0;
+            readBytesPerSecond = (current.readSectors - first.readSectors) * SectorSize / seconds;
+            writeBytesPerSecond = (current.writeSectors - first.writeSectors) * SectorSize / seconds;
+            readOperationsPerSecond = (current.readOperations - first.readOperations) / seconds;
+            writeOperationsPerSecond = (current.writeOperations - first.writeOperations) / seconds;
+            // io_ticks counts the milliseconds the device had requests queued.
+            utilization = qBound<qreal>(0, qreal(current.ioTicks - first.ioTicks) / elapsed, 1);
+        }
+
+        if (partition->readBytesPerSecond != readBytesPerSecond
+                || partition->writeBytesPerSecond != writeBytesPerSecond
+                || partition->readOperationsPerSecond != readOperationsPerSecond
+                || partition->writeOperationsPerSecond != writeOperationsPerSecond
+                || partition->requestsInFlight != current.inFlight
+                || partition->utilization != utilization) {
+            partition->readBytesPerSecond = readBytesPerSecond;
+            partition->writeBytesPerSecond = writeBytesPerSecond;
+            partition->readOperationsPerSecond = readOperationsPerSecond;
+            partition->writeOperationsPerSecond = writeOperationsPerSecond;
+            partition->requestsInFlight = current.inFlight;
+            partition->utilization = utilization;
+            changedPartitions.append(partition);
+        }
+    }
+
+    // Let go of devices that are no longer mounted.
+    for (auto it = m_devices.begin(); it != m_devices.end();) {
+        if (!sampledDevices.contains(it.key())) {
+            ::close(it->fd);
+            it = m_devices.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    return changedPartitions;
+}
+
+void IoStatsSampler::clear()
+{
+    for (const Device &device : m_devices) {
+        ::close(device.fd);
+    }
+    m_devices.clear();
+}
+
+bool IoStatsSampler::read(int fd, Sample *sample)
+{
+    char buffer[256];
+    const ssize_t length = ::pread(fd, buffer, sizeof(buffer) - 1, 0);
+    if (length <= 0) {
+        return false;
+    }
+    buffer[length] = '\0';
+
+    // See Documentation/block/stat.rst, the first eleven fields are present on all supported kernels.
+    quint64 fields[11];
+    char *position = buffer;
+    for (quint64 &field : fields) {
+        char *end = nullptr;
+        field = ::strtoull(position, &end, 10);
+        if (end == position) {
+            return false;
+        }
+        position = end;
+    }
+
+    sample->readOperations = fields[0];
+    sample->readSectors = fields[2];
+    sample->writeOperations = fields[4];
+    sample->writeSectors = fields[6];
+    sample->inFlight = int(fields[8]);
+    sample->ioTicks = fields[9];
+
+    return true;
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2026 Nemo Mobile Project
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#ifndef IOSTATSSAMPLER_P_H
+#define IOSTATSSAMPLER_P_H
+
+#include <QExplicitlySharedDataPointer>
+#include <QHash>
+#include <QVector>
+
+class PartitionPrivate;
+
+// Derives throughput, IOPS and utilization of partitions from the counters in
+// /sys/class/block/<dev>/stat. The stat files are kept open between samples.
+class IoStatsSampler
+{
+public:
+    typedef QVector<QExplicitlySharedDataPointer<PartitionPrivate>> PartitionList;
+
+    IoStatsSampler();
+    ~IoStatsSampler();
+
+    // Updates the statistics of the given partitions and returns the ones that changed.
+    PartitionList sample(const PartitionList &partitions);
+    // Closes the stat files and forgets the collected samples.
+    void clear();
+
+private:
+    struct Sample
+    {
+        qint64 time = 0;
+        quint64 readOperations = 0;
+        quint64 readSectors = 0;
+        quint64 writeOperations = 0;
+        quint64 writeSectors = 0;
+        quint64 ioTicks = 0;
+        int inFlight = 0;
+    };
+
+    struct Device
+    {
+        int fd = -1;
+        QVector<Sample> window;
+    };
+
+    static bool read(int fd, Sample *sample);
+
+    QHash<QString, Device> m_devices;
+};
+
+#endif
@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2026 Nemo Mobile Project
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include "luksbenchmark_p.h"
+#include "logging_p.h"
+
+#include <QElapsedTimer>
+
+#include <algorithm>
+
+#include <openssl/evp.h>
+#include <unistd.h>
+
+namespace {
+
+const int SectorSize = 4096;
+// Each measurement runs at least this long to even out frequency scaling.
+const qint64 MeasurementTime = 250;
+// cryptsetup refuses fewer PBKDF2 iterations for LUKS1 key slots.
+const qint64 MinimumIterations = 1000;
+// Below this the memory hard Argon2 of LUKS2 is capped so low that it competes with the
+// running system for memory, which makes unlock times unpredictable.
+const qint64 Luks2MemoryThreshold = qint64(1024) * 1024 * 1024;
+
+// Bytes per second of XTS over dm-crypt sized sectors, with the plain64 sector number as the IV.
+qint64 cipherThroughput(bool encrypt)
+{
+    EVP_CIPHER_CTX *context = EVP_CIPHER_CTX_new();
+    if (!context) {
+        return -1;
+    }
+
+    unsigned char key[64];
+    for (unsigned int i = 0; i < sizeof(key); ++i) {
+        key[i] = static_cast<unsigned char>(i * 7 + 1);
+    }
+    QByteArray input(SectorSize, '\x5a');
+    QByteArray output(SectorSize + EVP_MAX_BLOCK_LENGTH, '\0');
+
+    // Expand the key once, like dm-crypt does, each sector only sets its IV.
+    if (EVP_CipherInit_ex(context, EVP_aes_256_xts(), nullptr, key, nullptr, encrypt ? 1 : 0) != 1) {
+        EVP_CIPHER_CTX_free(context);
+        return -1;
+    }
+
+    qint64 bytes = 0;
+    quint64 sector = 0;
+    QElapsedTimer timer;
+    timer.start();
+
+    do {
+        for (int i = 0; i < 256; ++i, ++sector) {
+            unsigned char iv[16] = {};
+            for (unsigned int byte = 0; byte < sizeof(sector); ++byte) {
+                iv[byte] = static_cast<unsigned char>(sector >> (8 * byte));
+            }
+
+            int length = 0;
+            if (EVP_CipherInit_ex(context, nullptr, nullptr, nullptr, iv, -1) != 1
+                    || EVP_CipherUpdate(context, reinterpret_cast<unsigned char *>(output.data()), &length,
+                                        reinterpret_cast<const unsigned char *>(input.constData()), SectorSize) != 1) {
+                EVP_CIPHER_CTX_free(context);
+                return -1;
+            }
+            bytes += length;
+        }
+    } while (timer.elapsed() < MeasurementTime);
+
+    const qint64 elapsed = timer.nsecsElapsed();
+    EVP_CIPHER_CTX_free(context);
+
+    return elapsed > 0 ? bytes * 1000000000LL / elapsed : -1;
+}
+
+qint64 pbkdf2Speed()
+{
+    static const char passphrase[] = "benchmark";
+    const unsigned char salt[32] = {};
+    unsigned char key[32];
+
+    int iterations = 1000;
+    for (;;) {
+        QElapsedTimer timer;
+        timer.start();
+        if (PKCS5_PBKDF2_HMAC(passphrase, sizeof(passphrase) - 1, salt, sizeof(salt), iterations,
+                              EVP_sha256(), sizeof(key), key) != 1) {
+            return -1;
+        }
+        const qint64 elapsed = timer.nsecsElapsed();
+
+        if (elapsed >= MeasurementTime * 1000000 || iterations >= (1 << 28)) {
+            return elapsed > 0 ? qint64(iterations) * 1000000000LL / elapsed : -1;
+        }
+        iterations *= 2;
+    }
+}
+
+}
+
+LuksBenchmark::Result LuksBenchmark::run()
+{
+    Result result;
+    result.encryptionBytesPerSecond = cipherThroughput(true);
+    result.decryptionBytesPerSecond = cipherThroughput(false);
+    result.pbkdf2IterationsPerSecond = pbkdf2Speed();
+
+    const long pages = ::sysconf(_SC_PHYS_PAGES);
+    const long pageSize = ::sysconf(_SC_PAGESIZE);
+    if (pages > 0 && pageSize > 0) {
+        result.physicalMemory = qint64(pages) * pageSize;
+    }
+
+    qCInfo(lcMemoryCardLog) << "Encryption benchmark:" << result.cipher << result.keySize
+                            << "encrypt" << result.encryptionBytesPerSecond
+                            << "decrypt" << result.decryptionBytesPerSecond << "B/s,"
+                            << "pbkdf2-sha256" << result.pbkdf2IterationsPerSecond << "iterations/s";
+
+    return result;
+}
+
+QVariantMap LuksBenchmark::recommend(const Result &result, int targetUnlockTime)
+{
+    QVariantMap recommendation;
+    recommendation.insert(QStringLiteral("cipher"), result.cipher);
+    recommendation.insert(QStringLiteral("keySize"), result.keySize);
+    recommendation.insert(QStringLiteral("encryptionBytesPerSecond"), result.encryptionBytesPerSecond);
+    recommendation.insert(QStringLiteral("decryptionBytesPerSecond"), result.decryptionBytesPerSecond);
+    recommendation.insert(QStringLiteral("pbkdf2IterationsPerSecond"), result.pbkdf2IterationsPerSecond);
+    recommendation.insert(QStringLiteral("targetUnlockTime"), targetUnlockTime);
+
+    if (!result.isValid()) {
+        return recommendation;
+    }
+
+    const bool luks1 = result.physicalMemory > 0 && result.physicalMemory < Luks2MemoryThreshold;
+
+    // Same key as the format arguments so that the recommendation can be passed on as is.
+    recommendation.insert(QStringLiteral("encrypt-type"), luks1 ? QStringLiteral("luks1") : QStringLiteral("luks2"));
+
+    if (luks1) {
+        const qint64 iterations = std::max(MinimumIterations,
+                                           result.pbkdf2IterationsPerSecond * targetUnlockTime / 1000);
+        recommendation.insert(QStringLiteral("pbkdf"), QStringLiteral("pbkdf2"));
+        recommendation.insert(QStringLiteral("pbkdfIterations"), iterations);
+        recommendation.insert(QStringLiteral("estimatedUnlockTime"),
+                              iterations * 1000 / result.pbkdf2IterationsPerSecond);
+    } else {
+        // Sized by cryptsetup itself, nothing measured here tells how long it will take.
+        recommendation.insert(QStringLiteral("pbkdf"), QStringLiteral("argon2id"));
+    }
+
+    return recommendation;
+}
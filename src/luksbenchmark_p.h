@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2026 Nemo Mobile Project
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#ifndef LUKSBENCHMARK_P_H
+#define LUKSBENCHMARK_P_H
+
+#include <QString>
+#include <QVariantMap>
+
+// In-process estimate of the LUKS encryption cost on this device, the
+// equivalent of cryptsetup benchmark for the default LUKS parameters.
+namespace LuksBenchmark {
+
+struct Result
+{
+    // Default dm-crypt cipher of cryptsetup.
+    QString cipher = QStringLiteral("aes-xts-plain64");
+    int keySize = 512;
+    qint64 encryptionBytesPerSecond = -1;
+    qint64 decryptionBytesPerSecond = -1;
+    // PBKDF2-SHA256 as used by LUKS1 key slots.
+    qint64 pbkdf2IterationsPerSecond = -1;
+    qint64 physicalMemory = -1;
+
+    bool isValid() const { return pbkdf2IterationsPerSecond > 0; }
+};
+
+// Blocks for roughly a second, run in a worker thread.
+Result run();
+
+// LUKS parameters for unlocking in targetUnlockTime milliseconds on this device. The
+// target only applies to LUKS1 PBKDF2 iterations. LUKS2 Argon2id is sized by cryptsetup
+// and has no estimatedUnlockTime.
+QVariantMap recommend(const Result &result, int targetUnlockTime);
+
+}
+
+#endif
@@ -157,6 +157,71 @@ qint64 Partition::bytesFree() const
     return d ? d->bytesFree : -1;
 }
 
+qint64 Partition::readBytesPerSecond() const
+{
+    return d ? d->readBytesPerSecond : -1;
+}
+
+qint64 Partition::writeBytesPerSecond() const
+{
+    return d ? d->writeBytesPerSecond : -1;
+}
+
+qreal Partition::readOperationsPerSecond() const
+{
+    return d ? d->readOperationsPerSecond : -1;
+}
+
+qreal Partition::writeOperationsPerSecond() const
+{
+    return d ? d->writeOperationsPerSecond : -1;
+}
+
+int Partition::requestsInFlight() const
+{
+    return d ? d->requestsInFlight : -1;
+}
+
+qreal Partition::utilization() const
+{
+    return d ? d->utilization : -1;
+}
+
+int Partition::lifeTimeEstimate() const
+{
+    return d ? d->lifeTimeEstimate : -1;
+}
+
+Partition::PreEolInfo Partition::preEolInfo() const
+{
+    return d ? d->preEolInfo : PreEolUndefined;
+}
+
+qint64 Partition::filesystemBytesWritten() const
+{
+    return d ? d->filesystemBytesWritten : -1;
+}
+
+qint64 Partition::bytesWrittenSinceBoot() const
+{
+    return d ? d->bytesWrittenSinceBoot : -1;
+}
+
+qint64 Partition::bytesWritten() const
+{
+    return d ? d->bytesWritten : -1;
+}
+
+int Partition::writebackMaxRatio() const
+{
+    return d ? d->writebackMaxRatio : -1;
+}
+
+bool Partition::writebackStrictLimit() const
+{
+    return d ? d->writebackStrictLimit : false;
+}
+
 void Partition::refresh()
 {
     if (const auto manager = d ? d->manager : nullptr) {
@@ -165,3 +230,10 @@ void Partition::refresh()
         emit manager->partitionChanged(*this);
     }
 }
+
+void Partition::trim()
+{
+    if (const auto manager = d ? d->manager : nullptr) {
+        manager->trim(*this);
+    }
+}
@@ -96,6 +96,29 @@ public:
         ErrorDeviceBusy
     };
 
+    // Mount options selected by file system type.
+    enum MountProfile {
+        MountProfileFlash,      // Avoids metadata writes, the default for removable flash media
+        MountProfileDurable,    // Writes data out early for media that is often pulled out
+        MountProfileNone        // Only the udisks2 defaults
+    };
+
+    // Steps of a safe eject in the order they are run.
+    enum EjectStep {
+        EjectFlush,         // syncfs() of the mounted file system
+        EjectUnmount,
+        EjectLock,          // Only for encrypted partitions
+        EjectPowerOff       // Only for drives that can be powered off
+    };
+
+    // JEDEC eMMC pre-EOL information, consumed reserved blocks.
+    enum PreEolInfo {
+        PreEolUndefined,
+        PreEolNormal,
+        PreEolWarning,      // 80% of the reserved blocks consumed
+        PreEolUrgent
+    };
+
     Partition();
     Partition(const Partition &partition);
     Partition &operator =(const Partition &partition);
@@ -129,7 +152,24 @@ public:
     qint64 bytesTotal() const;
     qint64 bytesFree() const;
 
+    qint64 readBytesPerSecond() const;
+    qint64 writeBytesPerSecond() const;
+    qreal readOperationsPerSecond() const;
+    qreal writeOperationsPerSecond() const;
+    int requestsInFlight() const;
+    qreal utilization() const;
+
+    int lifeTimeEstimate() const;
+    PreEolInfo preEolInfo() const;
+    qint64 filesystemBytesWritten() const;
+    qint64 bytesWrittenSinceBoot() const;
+    qint64 bytesWritten() const;
+
+    int writebackMaxRatio() const;
+    bool writebackStrictLimit() const;
+
     void refresh();
+    void trim();
 
 private:
     friend class PartitionManagerPrivate;
@@ -46,6 +46,19 @@ public:
         , bytesAvailable(-1)
         , bytesTotal(-1)
         , bytesFree(-1)
+        , readBytesPerSecond(-1)
+        , writeBytesPerSecond(-1)
+        , readOperationsPerSecond(-1)
+        , writeOperationsPerSecond(-1)
+        , requestsInFlight(-1)
+        , utilization(-1)
+        , lifeTimeEstimate(-1)
+        , preEolInfo(Partition::PreEolUndefined)
+        , filesystemBytesWritten(-1)
+        , bytesWrittenSinceBoot(-1)
+        , bytesWritten(-1)
+        , writebackMaxRatio(-1)
+        , writebackStrictLimit(false)
         , storageType(Partition::Invalid)
         , status(Partition::Unmounted)
         , readOnly(true)
@@ -56,6 +69,7 @@ public:
         , mountFailed(false)
         , deviceRoot(false)
         , valid(false)
+        , provisional(false)
     {
     }
 
@@ -69,6 +83,8 @@ public:
     QString deviceName;
     QString devicePath;
     QString deviceLabel;
+    // File system UUID, empty for the internal partitions read from mtab.
+    QString uuid;
     QString mountPath;
     QString filesystemType;
     QString activeState;
@@ -76,6 +92,20 @@ public:
     qint64 bytesAvailable;
     qint64 bytesTotal;
     qint64 bytesFree;
+    // I/O statistics, -1 while not sampled.
+    qint64 readBytesPerSecond;
+    qint64 writeBytesPerSecond;
+    qreal readOperationsPerSecond;
+    qreal writeOperationsPerSecond;
+    int requestsInFlight;
+    qreal utilization;
+    int lifeTimeEstimate;
+    Partition::PreEolInfo preEolInfo;
+    qint64 filesystemBytesWritten;
+    qint64 bytesWrittenSinceBoot;
+    qint64 bytesWritten;
+    int writebackMaxRatio;
+    bool writebackStrictLimit;
     Partition::StorageType storageType;
     Partition::Status status;
     QVariantMap drive;
@@ -88,6 +118,8 @@ public:
     bool deviceRoot;
     // If valid, only mount status and available bytes will be checked
     bool valid;
+    // Created from a kernel uevent, udisks2 has not published the block device yet.
+    bool provisional;
 };
 
 #endif
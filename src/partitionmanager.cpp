@@ -33,9 +33,18 @@
 #include "partitionmanager_p.h"
 #include "udisks2monitor_p.h"
 #include "udisks2blockdevices_p.h"
+#include "bdi_p.h"
+#include "diskquota_p.h"
+#include "luksbenchmark_p.h"
+#include "storagemetrics_p.h"
+#include "sysfsblock_p.h"
+#include "trimscheduler_p.h"
+#include "weartelemetry_p.h"
 #include "logging_p.h"
 
+#include <QElapsedTimer>
 #include <QFile>
+#include <QProcess>
 #include <QRegularExpression>
 #include <QRunnable>
 #include <QThreadPool>
@@ -44,15 +53,26 @@
 
 #include <algorithm>
 #include <blkid/blkid.h>
+#include <errno.h>
+#include <fcntl.h>
 #include <limits>
 #include <linux/limits.h>
 #include <mntent.h>
+#include <string.h>
 #include <sys/statvfs.h>
-#include <sys/quota.h>
 #include <unistd.h>
 
 static const auto userName = QString(qgetenv("USER"));
 
+static quint64 floorPowerOfTwo(quint64 value)
+{
+    quint64 power = 1;
+    while (power <= value / 2) {
+        power *= 2;
+    }
+    return power;
+}
+
 static const QEvent::Type RefreshFinishedEvent = QEvent::Type(QEvent::User + 1);
 
 class RefreshEvent : public QEvent
@@ -72,22 +92,22 @@ public:
     StatTask(PartitionManagerPrivate *owner, const PartitionManagerPrivate::PartitionList &partitions)
         : m_owner(owner), m_partitions(partitions)
     {
+        // Latency includes the time spent queued in the thread pool.
+        m_timer.start();
     }
 
     void run() override
     {
+        StorageMetrics::count(QStringLiteral("statPartitions"), m_partitions.count());
+
         PartitionManagerPrivate::PartitionList changedPartitions;
 
         for (auto partition : m_partitions) {
             qint64 quotaAvailable = std::numeric_limits<qint64>::max();
-            struct if_dqblk quota = {};
-
-            if (::quotactl(QCMD(Q_GETQUOTA, USRQUOTA), partition->devicePath.toUtf8().constData(),
-                           ::getuid(), (caddr_t)&quota) == 0
-                    && quota.dqb_bsoftlimit != 0) {
-                quotaAvailable = std::max(static_cast<qint64>(dbtob(quota.dqb_bsoftlimit))
-                                          - static_cast<qint64>(quota.dqb_curspace),
-                                          0LL);
+            DiskQuota::Usage quota;
+
+            if (DiskQuota::usage(partition->devicePath, ::getuid(), &quota) && quota.bytesLimit != 0) {
+                quotaAvailable = std::max(quota.bytesLimit - quota.bytesUsed, 0LL);
             }
 
             struct statvfs64 stat;
@@ -95,16 +115,28 @@ public:
                 qint64 bytesFree = stat.f_bfree * stat.f_frsize;
                 qint64 bytesAvailable = std::min((qint64)(stat.f_bavail * stat.f_frsize), quotaAvailable);
 
-                if (partition->bytesFree != bytesFree || partition->bytesAvailable != bytesAvailable) {
+                const WearTelemetry::Wear wear = WearTelemetry::read(partition->devicePath);
+
+                if (partition->bytesFree != bytesFree || partition->bytesAvailable != bytesAvailable
+                        || partition->bytesWrittenSinceBoot != wear.bytesWrittenSinceBoot
+                        || partition->filesystemBytesWritten != wear.filesystemBytesWritten
+                        || partition->lifeTimeEstimate != wear.lifeTimeEstimate
+                        || partition->preEolInfo != wear.preEolInfo) {
                     changedPartitions.append(partition);
                 }
                 partition->bytesFree = bytesFree;
                 partition->bytesAvailable = bytesAvailable;
                 partition->bytesTotal = stat.f_blocks * stat.f_frsize;
                 partition->readOnly = (stat.f_flag & ST_RDONLY) != 0;
+                partition->lifeTimeEstimate = wear.lifeTimeEstimate;
+                partition->preEolInfo = static_cast<Partition::PreEolInfo>(wear.preEolInfo);
+                partition->filesystemBytesWritten = wear.filesystemBytesWritten;
+                partition->bytesWrittenSinceBoot = wear.bytesWrittenSinceBoot;
             }
         }
 
+        StorageMetrics::time(QStringLiteral("statBatch"), m_timer.elapsed());
+
         if (m_owner) {
             QCoreApplication::postEvent(m_owner, new RefreshEvent(changedPartitions));
         }
@@ -113,25 +145,137 @@ public:
 private:
     QPointer<PartitionManagerPrivate> m_owner;
     PartitionManagerPrivate::PartitionList m_partitions;
+    QElapsedTimer m_timer;
+};
+
+static const QEvent::Type SyncFinishedEvent = QEvent::Type(QEvent::User + 3);
+
+class SyncEvent : public QEvent
+{
+public:
+    SyncEvent(const QString &devicePath, int error)
+        : QEvent(SyncFinishedEvent), m_devicePath(devicePath), m_error(error)
+    {
+    }
+
+    QString m_devicePath;
+    int m_error;
+};
+
+class SyncTask : public QRunnable
+{
+public:
+    SyncTask(PartitionManagerPrivate *owner, const QString &devicePath, const QString &mountPath)
+        : m_owner(owner), m_devicePath(devicePath), m_mountPath(mountPath)
+    {
+    }
+
+    void run() override
+    {
+        int error = 0;
+        const int fd = ::open(QFile::encodeName(m_mountPath).constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd < 0) {
+            error = errno;
+        } else {
+            if (::syncfs(fd) != 0) {
+                error = errno;
+            }
+            ::close(fd);
+        }
+
+        if (m_owner) {
+            QCoreApplication::postEvent(m_owner, new SyncEvent(m_devicePath, error));
+        }
+    }
+
+private:
+    QPointer<PartitionManagerPrivate> m_owner;
+    QString m_devicePath;
+    QString m_mountPath;
 };
 
+static const QEvent::Type EncryptionBenchmarkFinishedEvent = QEvent::Type(QEvent::User + 4);
+
+class EncryptionBenchmarkEvent : public QEvent
+{
+public:
+    EncryptionBenchmarkEvent(const LuksBenchmark::Result &result)
+        : QEvent(EncryptionBenchmarkFinishedEvent), m_result(result)
+    {
+    }
+
+    LuksBenchmark::Result m_result;
+};
+
+class EncryptionBenchmarkTask : public QRunnable
+{
+public:
+    EncryptionBenchmarkTask(PartitionManagerPrivate *owner)
+        : m_owner(owner)
+    {
+    }
+
+    void run() override
+    {
+        const LuksBenchmark::Result result = LuksBenchmark::run();
+
+        if (m_owner) {
+            QCoreApplication::postEvent(m_owner, new EncryptionBenchmarkEvent(result));
+        }
+    }
+
+private:
+    QPointer<PartitionManagerPrivate> m_owner;
+};
+
+static Partition::Error errorFromErrno(int error)
+{
+    switch (error) {
+    case EPERM:
+    case EACCES:
+        return Partition::ErrorNotAuthorized;
+    case EOPNOTSUPP:
+    case ENOTTY:
+    case EROFS:
+        return Partition::ErrorNotSupported;
+    case EBUSY:
+        return Partition::ErrorDeviceBusy;
+    case ECANCELED:
+        return Partition::ErrorCancelled;
+    default:
+        return Partition::ErrorFailed;
+    }
+}
+
+// FITRIM needs CAP_SYS_ADMIN, the helper runs it on behalf of the user.
+static const QString TrimHelperPath = QStringLiteral("/usr/libexec/storagetrim");
+
+static QString storageKey(const PartitionPrivate *partition)
+{
+    // Identifies a partition in persistent state. External media are identified by file system
+    // uuid, or label without one, so that swapping cards in a slot is noticed. Labels like
+    // "NO NAME" are shared by many cards so the uuid comes first.
+    if (partition->storageType == Partition::External) {
+        if (!partition->uuid.isEmpty()) {
+            return partition->uuid;
+        } else if (!partition->deviceLabel.isEmpty()) {
+            return partition->deviceLabel;
+        }
+    }
+    return partition->devicePath;
+}
+
 PartitionManagerPrivate *PartitionManagerPrivate::sharedInstance = nullptr;
 
 PartitionManagerPrivate::PartitionManagerPrivate()
+    : m_populating(true)
+    , m_ioStatsSubscribers(0)
+    , m_encryptionBenchmarkTarget(-1)
 {
     Q_ASSERT(!sharedInstance);
 
     sharedInstance = this;
-    m_udisksMonitor.reset(new UDisks2::Monitor(this));
-    connect(m_udisksMonitor.data(), &UDisks2::Monitor::status, this, &PartitionManagerPrivate::status);
-    connect(m_udisksMonitor.data(), &UDisks2::Monitor::errorMessage, this, &PartitionManagerPrivate::errorMessage);
-    connect(m_udisksMonitor.data(), &UDisks2::Monitor::lockError, this, &PartitionManagerPrivate::lockError);
-    connect(m_udisksMonitor.data(), &UDisks2::Monitor::unlockError, this, &PartitionManagerPrivate::unlockError);
-    connect(m_udisksMonitor.data(), &UDisks2::Monitor::mountError, this, &PartitionManagerPrivate::mountError);
-    connect(m_udisksMonitor.data(), &UDisks2::Monitor::unmountError, this, &PartitionManagerPrivate::unmountError);
-    connect(m_udisksMonitor.data(), &UDisks2::Monitor::formatError, this, &PartitionManagerPrivate::formatError);
-    connect(UDisks2::BlockDevices::instance(), &UDisks2::BlockDevices::externalStoragesPopulated,
-            this, &PartitionManagerPrivate::externalStoragesPopulatedChanged);
+    m_readinessTimer.start();
 
     QVariantMap defaultDrive;
     defaultDrive.insert(QLatin1String("model"), QString());
@@ -189,12 +333,38 @@ PartitionManagerPrivate::PartitionManagerPrivate()
     m_refreshTimer.setInterval(10);
     connect(&m_refreshTimer, SIGNAL(timeout()),
             this, SLOT(refresh()));
+
+    m_storageWorker.setMaxThreadCount(1);
+
+    m_ejectProgressTimer.setInterval(250);
+    connect(&m_ejectProgressTimer, &QTimer::timeout, this, &PartitionManagerPrivate::reportEjectProgress);
+
+    m_ioStatsTimer.setInterval(1000);
+    connect(&m_ioStatsTimer, &QTimer::timeout, this, &PartitionManagerPrivate::sampleIoStatistics);
+
+    connect(this, &PartitionManagerPrivate::partitionChanged, this, []() {
+        StorageMetrics::count(QStringLiteral("partitionChanged"));
+    });
+
+    // The internal partitions above are served from mtab, udisks2 is brought up once
+    // the event loop runs so that the first model does not wait for it.
+    QTimer::singleShot(0, this, &PartitionManagerPrivate::ensureMonitor);
 }
 
 PartitionManagerPrivate::~PartitionManagerPrivate()
 {
     sharedInstance = nullptr;
 
+    // A trim can take minutes, it is abandoned rather than waited for.
+    for (QProcess *process : m_trimming) {
+        disconnect(process, nullptr, this, nullptr);
+        process->kill();
+        process->waitForFinished();
+        delete process;
+    }
+
+    m_storageWorker.waitForDone();
+
     for (auto partition : m_partitions) {
         partition->manager = nullptr;
     }
@@ -205,6 +375,107 @@ PartitionManagerPrivate *PartitionManagerPrivate::instance()
     return sharedInstance ? sharedInstance : new PartitionManagerPrivate;
 }
 
+void PartitionManagerPrivate::ensureMonitor()
+{
+    if (m_udisksMonitor) {
+        return;
+    }
+
+    m_udisksMonitor.reset(new UDisks2::Monitor(this));
+    connect(m_udisksMonitor.data(), &UDisks2::Monitor::status, this, &PartitionManagerPrivate::status);
+    connect(m_udisksMonitor.data(), &UDisks2::Monitor::errorMessage, this, &PartitionManagerPrivate::errorMessage);
+    connect(m_udisksMonitor.data(), &UDisks2::Monitor::lockError,
+            this, [this](const QString &, Partition::Error error) {
+        emit lockError(error);
+    });
+    connect(m_udisksMonitor.data(), &UDisks2::Monitor::unlockError, this, &PartitionManagerPrivate::unlockError);
+    connect(m_udisksMonitor.data(), &UDisks2::Monitor::unlocked, this, &PartitionManagerPrivate::unlocked);
+    connect(m_udisksMonitor.data(), &UDisks2::Monitor::mountError, this, &PartitionManagerPrivate::mountError);
+    connect(m_udisksMonitor.data(), &UDisks2::Monitor::unmountError,
+            this, [this](const QString &, Partition::Error error) {
+        emit unmountError(error);
+    });
+    connect(m_udisksMonitor.data(), &UDisks2::Monitor::formatError, this, &PartitionManagerPrivate::formatError);
+    connect(UDisks2::BlockDevices::instance(), &UDisks2::BlockDevices::externalStoragesPopulated,
+            this, [this]() {
+        markReady(QStringLiteral("externalStorages"));
+        setPopulating(false);
+        emit externalStoragesPopulatedChanged();
+    });
+
+    connect(m_udisksMonitor.data(), &UDisks2::Monitor::status, this, &PartitionManagerPrivate::ejectStatusChanged);
+    // The step fails once udisks2 reverts the status, the error is only remembered here.
+    connect(m_udisksMonitor.data(), &UDisks2::Monitor::unmountError,
+            this, [this](const QString &devicePath, Partition::Error error) {
+        auto it = m_ejects.find(devicePath);
+        if (it != m_ejects.end() && it->step == Partition::EjectUnmount) {
+            it->error = error;
+        }
+    });
+    connect(m_udisksMonitor.data(), &UDisks2::Monitor::lockError,
+            this, [this](const QString &devicePath, Partition::Error error) {
+        for (auto it = m_ejects.begin(); it != m_ejects.end(); ++it) {
+            if (it->step == Partition::EjectLock && it->backingDevicePath == devicePath) {
+                it->error = error;
+                return;
+            }
+        }
+    });
+    connect(m_udisksMonitor.data(), &UDisks2::Monitor::poweredOff, this, [this](const QString &devicePath) {
+        for (auto it = m_ejects.begin(); it != m_ejects.end(); ++it) {
+            if (it->step == Partition::EjectPowerOff
+                    && (it->backingDevicePath.isEmpty() ? it.key() : it->backingDevicePath) == devicePath) {
+                const QString ejectedPath = it.key();
+                finishEjectStep(ejectedPath, *it);
+                return;
+            }
+        }
+    });
+    connect(m_udisksMonitor.data(), &UDisks2::Monitor::powerOffError,
+            this, [this](const QString &devicePath, Partition::Error) {
+        // The file system is already flushed and detached, the drive just stays powered.
+        for (auto it = m_ejects.begin(); it != m_ejects.end(); ++it) {
+            if (it->step == Partition::EjectPowerOff
+                    && (it->backingDevicePath.isEmpty() ? it.key() : it->backingDevicePath) == devicePath) {
+                qCWarning(lcMemoryCardLog) << "Drive of" << it.key() << "was not powered off";
+                const QString ejectedPath = it.key();
+                finishEject(ejectedPath);
+                return;
+            }
+        }
+    });
+
+    markReady(QStringLiteral("monitor"));
+}
+
+bool PartitionManagerPrivate::populating() const
+{
+    return m_populating;
+}
+
+void PartitionManagerPrivate::setPopulating(bool populating)
+{
+    if (m_populating != populating) {
+        m_populating = populating;
+        emit populatingChanged();
+    }
+}
+
+QVariantMap PartitionManagerPrivate::readinessTimes() const
+{
+    return m_readinessTimes;
+}
+
+void PartitionManagerPrivate::markReady(const QString &milestone)
+{
+    if (!m_readinessTimes.contains(milestone)) {
+        const qint64 elapsed = m_readinessTimer.elapsed();
+        qCInfo(lcMemoryCardLog) << "Storage" << milestone << "ready in" << elapsed << "ms";
+        m_readinessTimes.insert(milestone, elapsed);
+        emit readinessTimesChanged();
+    }
+}
+
 Partition PartitionManagerPrivate::root() const
 {
     return m_root;
@@ -229,7 +500,7 @@ QVector<Partition> PartitionManagerPrivate::partitions(const Partition::StorageT
     return partitions;
 }
 
-void PartitionManagerPrivate::add(QExplicitlySharedDataPointer<PartitionPrivate> partition)
+int PartitionManagerPrivate::insertIndex(const QExplicitlySharedDataPointer<PartitionPrivate> &partition) const
 {
     int insertIndex = 0;
     for (const auto &existingPartition : m_partitions) {
@@ -239,13 +510,42 @@ void PartitionManagerPrivate::add(QExplicitlySharedDataPointer<PartitionPrivate>
         else
             break;
     }
+    return insertIndex;
+}
 
-    m_partitions.insert(insertIndex, partition);
+void PartitionManagerPrivate::add(QExplicitlySharedDataPointer<PartitionPrivate> partition)
+{
+    if (partition->storageType == Partition::External) {
+        m_storagePolicy.apply(partition.data());
+    }
+
+    m_partitions.insert(insertIndex(partition), partition);
     PartitionList addedPartitions = { partition };
     refresh(addedPartitions);
     emit partitionAdded(Partition(partition));
 }
 
+void PartitionManagerPrivate::complete(QExplicitlySharedDataPointer<PartitionPrivate> partition)
+{
+    const int index = m_partitions.indexOf(partition);
+    if (index < 0) {
+        return;
+    }
+
+    if (partition->storageType == Partition::External) {
+        m_storagePolicy.apply(partition.data());
+    }
+
+    m_partitions.removeAt(index);
+    const int newIndex = insertIndex(partition);
+    m_partitions.insert(newIndex, partition);
+
+    refresh(partition.data());
+    if (newIndex != index) {
+        emit partitionMoved(Partition(partition));
+    }
+}
+
 void PartitionManagerPrivate::remove(const PartitionList &partitions)
 {
     for (const auto &removedPartition : partitions) {
@@ -307,6 +607,9 @@ void PartitionManagerPrivate::refresh(const PartitionList &partitions)
         }
     }
 
+    QElapsedTimer mtabTimer;
+    mtabTimer.start();
+
     FILE *mtab = setmntent("/etc/mtab", "r");
     mntent mountEntry;
     char buffer[3 * PATH_MAX];
@@ -350,6 +653,8 @@ void PartitionManagerPrivate::refresh(const PartitionList &partitions)
 
     endmntent(mtab);
 
+    StorageMetrics::time(QStringLiteral("mtabParse"), mtabTimer.elapsed());
+
     PartitionList partitionsToStat;
 
     for (auto partition : partitions) {
@@ -376,36 +681,433 @@ bool PartitionManagerPrivate::isActionAllowed(const QString &devicePath, const Q
 
 void PartitionManagerPrivate::lock(const QString &devicePath)
 {
+    ensureMonitor();
     if (isActionAllowed(devicePath, QStringLiteral("lock")))
         m_udisksMonitor->lock(devicePath);
 }
 
 void PartitionManagerPrivate::unlock(const Partition &partition, const QString &passphrase)
 {
+    ensureMonitor();
     if (isActionAllowed(partition.devicePath(), QStringLiteral("unlock")))
         m_udisksMonitor->unlock(partition.devicePath(), passphrase);
 }
 
-void PartitionManagerPrivate::mount(const Partition &partition)
+void PartitionManagerPrivate::mount(const Partition &partition, Partition::MountProfile profile)
 {
+    ensureMonitor();
     if (isActionAllowed(partition.devicePath(), QStringLiteral("mount")))
-        m_udisksMonitor->mount(partition.devicePath());
+        m_udisksMonitor->mount(partition.devicePath(), profile);
 }
 
 void PartitionManagerPrivate::unmount(const Partition &partition)
 {
+    ensureMonitor();
     if (isActionAllowed(partition.devicePath(), QStringLiteral("unmount")))
         m_udisksMonitor->unmount(partition.devicePath());
 }
 
 void PartitionManagerPrivate::format(const QString &devicePath, const QString &filesystemType, const QVariantMap &arguments)
 {
+    ensureMonitor();
     if (isActionAllowed(devicePath, QStringLiteral("format")))
         m_udisksMonitor->format(devicePath, filesystemType, arguments);
 }
 
+void PartitionManagerPrivate::subscribeIoStatistics()
+{
+    if (m_ioStatsSubscribers++ == 0) {
+        sampleIoStatistics();
+        m_ioStatsTimer.start();
+    }
+}
+
+void PartitionManagerPrivate::unsubscribeIoStatistics()
+{
+    Q_ASSERT(m_ioStatsSubscribers > 0);
+
+    if (--m_ioStatsSubscribers == 0) {
+        m_ioStatsTimer.stop();
+        m_ioStatsSampler.clear();
+
+        for (const auto &partition : m_partitions) {
+            if (partition->requestsInFlight >= 0) {
+                partition->readBytesPerSecond = -1;
+                partition->writeBytesPerSecond = -1;
+                partition->readOperationsPerSecond = -1;
+                partition->writeOperationsPerSecond = -1;
+                partition->requestsInFlight = -1;
+                partition->utilization = -1;
+                emit partitionChanged(Partition(partition));
+            }
+        }
+    }
+}
+
+void PartitionManagerPrivate::sampleIoStatistics()
+{
+    const PartitionList changedPartitions = m_ioStatsSampler.sample(m_partitions);
+    for (const auto &partition : changedPartitions) {
+        emit partitionChanged(Partition(partition));
+    }
+}
+
+QVariantMap PartitionManagerPrivate::formatPreset(const QString &devicePath, const QString &filesystemType) const
+{
+    QVariantMap preset;
+
+    const SysfsBlock::Geometry geometry = SysfsBlock::geometry(devicePath);
+    if (!geometry.isValid()) {
+        qCWarning(lcMemoryCardLog) << "Cannot read block geometry of" << devicePath;
+        return preset;
+    }
+
+    // The optimal I/O size of a RAID or a USB bridge need not be a power of two, while
+    // the cluster and boundary sizes of the mkfs tools must be.
+    const quint64 eraseBlockSize = floorPowerOfTwo(geometry.eraseBlockSize());
+    QStringList mkfsArgs;
+
+    if (filesystemType.startsWith(QLatin1String("ext"))) {
+        const quint64 blockSize = 4096;
+        const quint64 stride = std::max<quint64>(1, eraseBlockSize / blockSize);
+        const QStringList extendedOptions = {
+            QStringLiteral("stride=%1").arg(stride),
+            QStringLiteral("stripe_width=%1").arg(stride),
+            geometry.supportsDiscard() ? QStringLiteral("discard") : QStringLiteral("nodiscard"),
+            // Keep formatting of large cards quick, the journal is small enough to be written right away.
+            QStringLiteral("lazy_itable_init=1"),
+            QStringLiteral("lazy_journal_init=0")
+        };
+        mkfsArgs << QStringLiteral("-b") << QString::number(blockSize)
+                 << QStringLiteral("-E") << extendedOptions.join(QLatin1Char(','));
+    } else if (filesystemType == QLatin1String("vfat")) {
+        // Clusters larger than 32 KiB are not understood by all FAT implementations.
+        const quint64 clusterSize = qBound<quint64>(4096, eraseBlockSize, 32 * 1024);
+        const quint64 sectorsPerCluster = std::max<quint64>(1, clusterSize / geometry.logicalBlockSize);
+        mkfsArgs << QStringLiteral("-s") << QString::number(floorPowerOfTwo(sectorsPerCluster));
+    } else if (filesystemType == QLatin1String("exfat")) {
+        const quint64 clusterSize = qBound<quint64>(4096, eraseBlockSize, 128 * 1024);
+        mkfsArgs << QStringLiteral("-c") << QString::number(clusterSize)
+                 << QStringLiteral("-b") << QString::number(eraseBlockSize);
+    }
+
+    preset.insert(QStringLiteral("eraseBlockSize"), eraseBlockSize);
+    preset.insert(QStringLiteral("startOffset"), geometry.startOffset);
+    preset.insert(QStringLiteral("discard"), geometry.supportsDiscard());
+    preset.insert(QStringLiteral("mkfs-args"), mkfsArgs);
+
+    // Alignment is only known against a size the device reported, the 4 MiB guess would flag
+    // every partition created on the usual 1 MiB boundary.
+    if (geometry.hasEraseBlockSize()) {
+        const bool aligned = geometry.startOffset % eraseBlockSize == 0;
+        preset.insert(QStringLiteral("aligned"), aligned);
+
+        if (!aligned) {
+            qCWarning(lcMemoryCardLog) << devicePath << "starts at" << geometry.startOffset
+                                       << "which is not aligned to the erase block size" << eraseBlockSize;
+        }
+    }
+
+    return preset;
+}
+
+void PartitionManagerPrivate::trim(const Partition &partition)
+{
+    for (const auto &ownPartition : m_partitions) {
+        if (ownPartition == partition.d) {
+            startTrim(ownPartition);
+            return;
+        }
+    }
+
+    qCWarning(lcMemoryCardLog) << "Cannot trim unknown partition" << partition.devicePath();
+    emit trimError(Partition::ErrorFailed);
+}
+
+void PartitionManagerPrivate::startTrim(const QExplicitlySharedDataPointer<PartitionPrivate> &partition)
+{
+    if (partition->status != Partition::Mounted) {
+        qCWarning(lcMemoryCardLog) << "Cannot trim" << partition->devicePath << "which is not mounted";
+        emit trimError(Partition::ErrorNotMounted);
+        return;
+    }
+
+    if (m_trimming.contains(partition->devicePath) || m_ejects.contains(partition->devicePath)) {
+        return;
+    }
+
+    if (!QFile::exists(TrimHelperPath)) {
+        qCWarning(lcMemoryCardLog) << "Cannot trim" << partition->mountPath << "without" << TrimHelperPath;
+        finishTrim(partition->devicePath, 0, 0, ENOTTY);
+        return;
+    }
+
+    QProcess *process = new QProcess(this);
+    m_trimming.insert(partition->devicePath, process);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    const QString devicePath = partition->devicePath;
+    connect(process, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
+            this, [this, process, devicePath, timer](int exitCode, QProcess::ExitStatus exitStatus) {
+        m_trimming.remove(devicePath);
+        process->deleteLater();
+
+        if (exitStatus != QProcess::NormalExit) {
+            // Killed for an eject of the device.
+            finishTrim(devicePath, 0, timer.elapsed(), ECANCELED);
+        } else if (exitCode != 0) {
+            finishTrim(devicePath, 0, timer.elapsed(), exitCode);
+        } else {
+            finishTrim(devicePath, process->readAllStandardOutput().trimmed().toLongLong(), timer.elapsed(), 0);
+        }
+    });
+    connect(process, &QProcess::errorOccurred, this, [this, process, devicePath](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart) {
+            m_trimming.remove(devicePath);
+            process->deleteLater();
+            finishTrim(devicePath, 0, 0, EPERM);
+        }
+    });
+
+    process->start(TrimHelperPath, QStringList() << partition->mountPath);
+}
+
+void PartitionManagerPrivate::finishTrim(const QString &devicePath, qint64 bytesTrimmed, qint64 duration, int error)
+{
+    for (const auto &partition : m_partitions) {
+        if (partition->devicePath != devicePath) {
+            continue;
+        }
+
+        if (error != 0) {
+            qCWarning(lcMemoryCardLog) << "Trimming" << partition->mountPath << "failed:" << strerror(error);
+
+            const Partition::Error reason = errorFromErrno(error);
+            if (m_trimScheduler && (reason == Partition::ErrorNotSupported || reason == Partition::ErrorNotAuthorized)) {
+                // Retrying in the next idle window would fail the same way.
+                m_trimScheduler->setUnsupported(storageKey(partition.data()));
+            }
+            emit trimError(reason);
+        } else {
+            qCInfo(lcMemoryCardLog) << "Trimmed" << bytesTrimmed << "bytes from"
+                                    << partition->mountPath << "in" << duration << "ms";
+            if (m_trimScheduler) {
+                m_trimScheduler->setTrimmed(storageKey(partition.data()));
+            }
+            emit trimmed(Partition(partition), bytesTrimmed, duration);
+        }
+        break;
+    }
+}
+
+void PartitionManagerPrivate::eject(const Partition &partition)
+{
+    ensureMonitor();
+
+    const QString devicePath = partition.devicePath();
+    if (!isActionAllowed(devicePath, QStringLiteral("eject")) || m_ejects.contains(devicePath)) {
+        return;
+    }
+
+    EjectOperation &operation = m_ejects[devicePath];
+    operation.mountPath = partition.mountPath();
+    operation.backingDevicePath = partition.cryptoBackingDevicePath();
+    operation.timer.start();
+
+    qCInfo(lcMemoryCardLog) << "Ejecting" << devicePath << "mounted at" << operation.mountPath;
+
+    // A running trim would delay the flush and keep the file system busy for the unmount.
+    if (QProcess *trim = m_trimming.value(devicePath)) {
+        qCInfo(lcMemoryCardLog) << "Cancelling trim of" << devicePath << "for eject";
+        trim->kill();
+    }
+
+    if (partition.status() == Partition::Mounted) {
+        operation.bdi = Bdi::name(operation.mountPath);
+        startEjectStep(devicePath, operation, Partition::EjectFlush);
+    } else if (!operation.backingDevicePath.isEmpty()) {
+        startEjectStep(devicePath, operation, Partition::EjectLock);
+    } else if (m_udisksMonitor->canPowerOff(devicePath)) {
+        startEjectStep(devicePath, operation, Partition::EjectPowerOff);
+    } else {
+        finishEject(devicePath);
+    }
+}
+
+void PartitionManagerPrivate::startEjectStep(const QString &devicePath, EjectOperation &operation,
+                                             Partition::EjectStep step)
+{
+    operation.step = step;
+    operation.error = Partition::ErrorFailed;
+    operation.stepTimer.start();
+
+    switch (step) {
+    case Partition::EjectFlush:
+        m_storageWorker.start(new SyncTask(this, devicePath, operation.mountPath));
+        reportEjectProgress();
+        m_ejectProgressTimer.start();
+        break;
+    case Partition::EjectUnmount:
+        m_udisksMonitor->unmount(devicePath);
+        break;
+    case Partition::EjectLock:
+        m_udisksMonitor->lock(operation.backingDevicePath);
+        break;
+    case Partition::EjectPowerOff:
+        m_udisksMonitor->powerOff(operation.backingDevicePath.isEmpty() ? devicePath : operation.backingDevicePath);
+        break;
+    }
+}
+
+void PartitionManagerPrivate::finishEjectStep(const QString &devicePath, EjectOperation &operation)
+{
+    const qint64 duration = operation.stepTimer.elapsed();
+    qCInfo(lcMemoryCardLog) << "Eject step" << operation.step << "of" << devicePath << "took" << duration << "ms";
+    emit ejectStepFinished(devicePath, operation.step, duration);
+
+    const QString powerOffPath = operation.backingDevicePath.isEmpty() ? devicePath : operation.backingDevicePath;
+
+    switch (operation.step) {
+    case Partition::EjectFlush:
+        startEjectStep(devicePath, operation, Partition::EjectUnmount);
+        return;
+    case Partition::EjectUnmount:
+        if (!operation.backingDevicePath.isEmpty()) {
+            startEjectStep(devicePath, operation, Partition::EjectLock);
+            return;
+        }
+        // fall through
+    case Partition::EjectLock:
+        if (m_udisksMonitor->canPowerOff(powerOffPath)) {
+            startEjectStep(devicePath, operation, Partition::EjectPowerOff);
+            return;
+        }
+        // fall through
+    case Partition::EjectPowerOff:
+        finishEject(devicePath);
+        return;
+    }
+}
+
+void PartitionManagerPrivate::finishEject(const QString &devicePath)
+{
+    const qint64 duration = m_ejects.value(devicePath).timer.elapsed();
+    m_ejects.remove(devicePath);
+
+    qCInfo(lcMemoryCardLog) << "Ejected" << devicePath << "in" << duration << "ms";
+    emit ejected(devicePath, duration);
+}
+
+void PartitionManagerPrivate::ejectStatusChanged(const QString &devicePath, Partition::Status status)
+{
+    for (auto it = m_ejects.begin(); it != m_ejects.end(); ++it) {
+        const QString ejectedPath = it.key();
+        if (it->step == Partition::EjectUnmount && ejectedPath == devicePath) {
+            if (status == Partition::Unmounted) {
+                finishEjectStep(ejectedPath, *it);
+            } else if (status == Partition::Mounted) {
+                // A failed unmount reverts to mounted, whether or not udisks2 reported a known error.
+                ejectStepFailed(ejectedPath);
+            }
+            return;
+        } else if (it->step == Partition::EjectLock && it->backingDevicePath == devicePath) {
+            if (status == Partition::Locked) {
+                finishEjectStep(ejectedPath, *it);
+            } else if (status == Partition::Unmounted) {
+                // A failed lock reverts to unmounted.
+                ejectStepFailed(ejectedPath);
+            }
+            return;
+        }
+    }
+}
+
+void PartitionManagerPrivate::ejectStepFailed(const QString &devicePath)
+{
+    auto it = m_ejects.find(devicePath);
+    if (it == m_ejects.end()) {
+        return;
+    }
+
+    const Partition::Error error = it->error;
+    qCWarning(lcMemoryCardLog) << "Eject of" << devicePath << "failed at step" << it->step;
+    m_ejects.erase(it);
+    emit ejectError(devicePath, error);
+}
+
+void PartitionManagerPrivate::reportEjectProgress()
+{
+    bool flushing = false;
+
+    for (auto it = m_ejects.constBegin(); it != m_ejects.constEnd(); ++it) {
+        if (it->step == Partition::EjectFlush) {
+            flushing = true;
+            const Bdi::WritebackState state = Bdi::writebackState(it->bdi);
+            emit ejectProgress(it.key(), state.dirtyBytes, state.writebackBytes);
+        }
+    }
+
+    if (!flushing) {
+        m_ejectProgressTimer.stop();
+    }
+}
+
+void PartitionManagerPrivate::benchmarkEncryption(int targetUnlockTime)
+{
+    // A running benchmark answers with the latest target.
+    const bool running = m_encryptionBenchmarkTarget >= 0;
+    m_encryptionBenchmarkTarget = std::max(targetUnlockTime, 0);
+
+    if (!running) {
+        // CPU bound, keep it off the storage worker.
+        QThreadPool::globalInstance()->start(new EncryptionBenchmarkTask(this));
+    }
+}
+
+bool PartitionManagerPrivate::idleTrimEnabled() const
+{
+    return !m_trimScheduler.isNull();
+}
+
+void PartitionManagerPrivate::setIdleTrimEnabled(bool enabled)
+{
+    if (enabled == idleTrimEnabled()) {
+        return;
+    }
+
+    if (enabled) {
+        m_trimScheduler.reset(new TrimScheduler);
+        connect(m_trimScheduler.data(), &TrimScheduler::trimRequested, this, &PartitionManagerPrivate::idleTrim);
+    } else {
+        m_trimScheduler.reset();
+    }
+
+    emit idleTrimEnabledChanged();
+}
+
+void PartitionManagerPrivate::idleTrim()
+{
+    if (!m_trimScheduler) {
+        return;
+    }
+
+    for (const auto &partition : m_partitions) {
+        if (partition->status == Partition::Mounted
+                && !partition->readOnly
+                && m_trimScheduler->isDue(storageKey(partition.data()))) {
+            startTrim(partition);
+        }
+    }
+}
+
 QString PartitionManagerPrivate::objectPath(const QString &devicePath) const
 {
+    if (!m_udisksMonitor) {
+        return QString();
+    }
+
     QString deviceName = devicePath.section(QChar('/'), 2);
     if (UDisks2::BlockDevices::instance()->hintAuto(devicePath)) {
         return UDisks2::BlockDevices::instance()->objectPath(devicePath);
@@ -434,13 +1136,14 @@ QStringList PartitionManagerPrivate::supportedFileSystems() const
 
 bool PartitionManagerPrivate::externalStoragesPopulated() const
 {
-    return UDisks2::BlockDevices::instance()->populated();
+    return m_udisksMonitor && UDisks2::BlockDevices::instance()->populated();
 }
 
 bool PartitionManagerPrivate::event(QEvent *event)
 {
     if (event->type() == RefreshFinishedEvent) {
         PartitionList partitions = static_cast<RefreshEvent*>(event)->m_partitions;
+        markReady(QStringLiteral("internalStorages"));
 
         for (auto partition : partitions) {
             for (auto ownPartition : m_partitions) {
@@ -462,6 +1165,20 @@ bool PartitionManagerPrivate::event(QEvent *event)
                         ownPartition->readOnly = partition->readOnly;
                         change = true;
                     }
+                    if (ownPartition->lifeTimeEstimate != partition->lifeTimeEstimate
+                            || ownPartition->preEolInfo != partition->preEolInfo
+                            || ownPartition->filesystemBytesWritten != partition->filesystemBytesWritten) {
+                        ownPartition->lifeTimeEstimate = partition->lifeTimeEstimate;
+                        ownPartition->preEolInfo = partition->preEolInfo;
+                        ownPartition->filesystemBytesWritten = partition->filesystemBytesWritten;
+                        change = true;
+                    }
+                    if (ownPartition->bytesWrittenSinceBoot != partition->bytesWrittenSinceBoot) {
+                        ownPartition->bytesWrittenSinceBoot = partition->bytesWrittenSinceBoot;
+                        ownPartition->bytesWritten = m_writeCounters.update(storageKey(ownPartition.data()),
+                                                                            partition->bytesWrittenSinceBoot);
+                        change = true;
+                    }
 
                     if (change)
                         emit partitionChanged(Partition(ownPartition));
@@ -470,6 +1187,30 @@ bool PartitionManagerPrivate::event(QEvent *event)
             }
         }
 
+        return true;
+    } else if (event->type() == EncryptionBenchmarkFinishedEvent) {
+        const LuksBenchmark::Result &result = static_cast<EncryptionBenchmarkEvent *>(event)->m_result;
+        const int targetUnlockTime = m_encryptionBenchmarkTarget;
+        m_encryptionBenchmarkTarget = -1;
+
+        emit encryptionBenchmarkFinished(LuksBenchmark::recommend(result, targetUnlockTime));
+
+        return true;
+    } else if (event->type() == SyncFinishedEvent) {
+        const SyncEvent *syncEvent = static_cast<SyncEvent *>(event);
+
+        auto it = m_ejects.find(syncEvent->m_devicePath);
+        if (it != m_ejects.end() && it->step == Partition::EjectFlush) {
+            if (syncEvent->m_error != 0) {
+                qCWarning(lcMemoryCardLog) << "Flushing" << it->mountPath << "failed:" << strerror(syncEvent->m_error);
+                m_ejects.erase(it);
+                emit ejectError(syncEvent->m_devicePath, errorFromErrno(syncEvent->m_error));
+            } else {
+                reportEjectProgress();
+                finishEjectStep(syncEvent->m_devicePath, *it);
+            }
+        }
+
         return true;
     }
 
@@ -485,6 +1226,7 @@ PartitionManager::PartitionManager(QObject *parent)
     connect(d.data(), &PartitionManagerPrivate::partitionRemoved, this, &PartitionManager::partitionRemoved);
     connect(d.data(), &PartitionManagerPrivate::externalStoragesPopulatedChanged,
             this, &PartitionManager::externalStoragesPopulated);
+    connect(d.data(), &PartitionManagerPrivate::trimmed, this, &PartitionManager::trimmed);
 }
 
 PartitionManager::~PartitionManager()
@@ -501,6 +1243,18 @@ QVector<Partition> PartitionManager::partitions(Partition::StorageTypes types) c
     return d->partitions(types);
 }
 
+QVariantMap PartitionManager::metrics() const
+{
+    QVariantMap metrics = StorageMetrics::snapshot();
+    metrics.insert(QStringLiteral("readinessTimes"), d->readinessTimes());
+    return metrics;
+}
+
+void PartitionManager::resetMetrics()
+{
+    StorageMetrics::reset();
+}
+
 void PartitionManager::refresh()
 {
     d->scheduleRefresh();
@@ -50,11 +50,16 @@ public:
 
     void refresh();
 
+    // Debugging aid: counters and timings of the storage stack, see StorageMetrics.
+    QVariantMap metrics() const;
+    void resetMetrics();
+
 signals:
     void partitionChanged(const Partition &partition);
     void partitionAdded(const Partition &partition);
     void partitionRemoved(const Partition &partition);
     void externalStoragesPopulated();
+    void trimmed(const Partition &partition, qint64 bytesTrimmed, qint64 duration);
 
 private:
     QExplicitlySharedDataPointer<PartitionManagerPrivate> d;
@@ -34,16 +34,26 @@
 
 #include "partitionmanager.h"
 #include "partition_p.h"
+#include "iostatssampler_p.h"
+#include "storagepolicy_p.h"
+#include "weartelemetry_p.h"
 
+#include <QElapsedTimer>
+#include <QHash>
 #include <QMap>
+#include <QSet>
 #include <QVector>
 #include <QScopedPointer>
+#include <QThreadPool>
 #include <QTimer>
 
 namespace UDisks2 {
 class Monitor;
 }
 
+class QProcess;
+class TrimScheduler;
+
 class PartitionManagerPrivate : public QObject, public QSharedData
 {
     Q_OBJECT
@@ -59,6 +69,8 @@ public:
     QVector<Partition> partitions(Partition::StorageTypes types) const;
 
     void add(QExplicitlySharedDataPointer<PartitionPrivate> partition);
+    // Applies the storage policy and sort order again once the drive details are known.
+    void complete(QExplicitlySharedDataPointer<PartitionPrivate> partition);
     void remove(const PartitionList &partitions);
 
     void scheduleRefresh();
@@ -67,36 +79,96 @@ public:
 
     void lock(const QString &devicePath);
     void unlock(const Partition &partition, const QString &passphrase);
-    void mount(const Partition &partition);
+    void mount(const Partition &partition, Partition::MountProfile profile = Partition::MountProfileFlash);
     void unmount(const Partition &partition);
     void format(const QString &devicePath, const QString &filesystemType, const QVariantMap &arguments);
+    QVariantMap formatPreset(const QString &devicePath, const QString &filesystemType) const;
+    void trim(const Partition &partition);
+    void eject(const Partition &partition);
+    // Measures the LUKS cipher and key derivation cost, answered with encryptionBenchmarkFinished.
+    void benchmarkEncryption(int targetUnlockTime);
+
+    bool idleTrimEnabled() const;
+    void setIdleTrimEnabled(bool enabled);
+
+    // I/O statistics are only sampled while there are subscribers.
+    void subscribeIoStatistics();
+    void unsubscribeIoStatistics();
 
     QString objectPath(const QString &devicePath) const;
 
     QStringList supportedFileSystems() const;
     bool externalStoragesPopulated() const;
 
+    // True until udisks2 has reported the external storages, the internal ones are available right away.
+    bool populating() const;
+    // Milliseconds from construction to each milestone reached so far.
+    QVariantMap readinessTimes() const;
+
     bool event(QEvent *event) override;
 
 public slots:
+    void ensureMonitor();
     void refresh();
+    void idleTrim();
+    void sampleIoStatistics();
+
+private slots:
+    void ejectStatusChanged(const QString &devicePath, Partition::Status status);
+    void ejectStepFailed(const QString &devicePath);
+    void reportEjectProgress();
 
 signals:
     void partitionChanged(const Partition &partition);
     void partitionAdded(const Partition &partition);
     void partitionRemoved(const Partition &partition);
+    void partitionMoved(const Partition &partition);
     void externalStoragesPopulatedChanged();
+    void populatingChanged();
+    void readinessTimesChanged();
+    void idleTrimEnabledChanged();
 
     void status(const QString &deviceName, Partition::Status);
     void errorMessage(const QString &objectPath, const QString &errorName);
     void lockError(Partition::Error error);
     void unlockError(Partition::Error error);
+    void unlocked(const QString &devicePath, qint64 duration);
     void mountError(Partition::Error error);
     void unmountError(Partition::Error error);
     void formatError(Partition::Error error);
+    void trimmed(const Partition &partition, qint64 bytesTrimmed, qint64 duration);
+    void trimError(Partition::Error error);
+    void encryptionBenchmarkFinished(const QVariantMap &recommendation);
+
+    // Eject is reported by device path as the partition is gone once the drive is powered off.
+    void ejectProgress(const QString &devicePath, qint64 dirtyBytes, qint64 writebackBytes);
+    void ejectStepFinished(const QString &devicePath, Partition::EjectStep step, qint64 duration);
+    void ejected(const QString &devicePath, qint64 duration);
+    void ejectError(const QString &devicePath, Partition::Error error);
 
 private:
     bool isActionAllowed(const QString &devicePath, const QString &action);
+    int insertIndex(const QExplicitlySharedDataPointer<PartitionPrivate> &partition) const;
+    void startTrim(const QExplicitlySharedDataPointer<PartitionPrivate> &partition);
+    void finishTrim(const QString &devicePath, qint64 bytesTrimmed, qint64 duration, int error);
+    void setPopulating(bool populating);
+    void markReady(const QString &milestone);
+
+    struct EjectOperation
+    {
+        QString mountPath;
+        QString backingDevicePath;
+        QString bdi;
+        Partition::EjectStep step;
+        // Reported by udisks2 before it reverts the status of the device.
+        Partition::Error error;
+        QElapsedTimer stepTimer;
+        QElapsedTimer timer;
+    };
+
+    void startEjectStep(const QString &devicePath, EjectOperation &operation, Partition::EjectStep step);
+    void finishEjectStep(const QString &devicePath, EjectOperation &operation);
+    void finishEject(const QString &devicePath);
     // TODO: This is leaking (Disks2::Monitor is never free'ed).
     static PartitionManagerPrivate *sharedInstance;
 
@@ -105,6 +177,27 @@ private:
     QTimer m_refreshTimer;
 
     QScopedPointer<UDisks2::Monitor> m_udisksMonitor;
+    bool m_populating;
+    QElapsedTimer m_readinessTimer;
+    QVariantMap m_readinessTimes;
+    QScopedPointer<TrimScheduler> m_trimScheduler;
+    StoragePolicy m_storagePolicy;
+    WriteCounterStore m_writeCounters;
+
+    IoStatsSampler m_ioStatsSampler;
+    QTimer m_ioStatsTimer;
+    int m_ioStatsSubscribers;
+
+    // Target unlock time of the running encryption benchmark, -1 when not running.
+    int m_encryptionBenchmarkTarget;
+
+    // Flushes of ejected file systems, serialized to keep them from competing for I/O.
+    QThreadPool m_storageWorker;
+    // Trim helper processes by device path.
+    QHash<QString, QProcess *> m_trimming;
+
+    QHash<QString, EjectOperation> m_ejects;
+    QTimer m_ejectProgressTimer;
 
     // Allow direct access to the Partitions.
     friend class UDisks2::Monitor;
@@ -42,14 +42,22 @@ PartitionModel::PartitionModel(QObject *parent)
     : QAbstractListModel(parent)
     , m_manager(PartitionManagerPrivate::instance())
     , m_storageTypes(Any | ExcludeParents)
+    , m_ioStatisticsEnabled(false)
 {
     m_partitions = m_manager->partitions(Partition::Any | Partition::ExcludeParents);
 
     connect(m_manager.data(), &PartitionManagerPrivate::partitionChanged, this, &PartitionModel::partitionChanged);
     connect(m_manager.data(), &PartitionManagerPrivate::partitionAdded, this, &PartitionModel::partitionAdded);
     connect(m_manager.data(), &PartitionManagerPrivate::partitionRemoved, this, &PartitionModel::partitionRemoved);
+    // Like an addition, a move is picked up by syncing the rows with the manager order.
+    connect(m_manager.data(), &PartitionManagerPrivate::partitionMoved, this, &PartitionModel::partitionAdded);
     connect(m_manager.data(), &PartitionManagerPrivate::externalStoragesPopulatedChanged,
             this, &PartitionModel::externalStoragesPopulatedChanged);
+    connect(m_manager.data(), &PartitionManagerPrivate::populatingChanged, this, &PartitionModel::populatingChanged);
+    connect(m_manager.data(), &PartitionManagerPrivate::readinessTimesChanged,
+            this, &PartitionModel::readinessTimesChanged);
+    connect(m_manager.data(), &PartitionManagerPrivate::idleTrimEnabledChanged,
+            this, &PartitionModel::idleTrimEnabledChanged);
 
     connect(m_manager.data(), &PartitionManagerPrivate::errorMessage, this, &PartitionModel::errorMessage);
 
@@ -59,6 +67,7 @@ PartitionModel::PartitionModel(QObject *parent)
     connect(m_manager.data(), &PartitionManagerPrivate::unlockError, this, [this](Partition::Error error) {
         emit unlockError(static_cast<PartitionModel::Error>(error));
     });
+    connect(m_manager.data(), &PartitionManagerPrivate::unlocked, this, &PartitionModel::unlocked);
 
     connect(m_manager.data(), &PartitionManagerPrivate::mountError, this, [this](Partition::Error error) {
         emit mountError(static_cast<PartitionModel::Error>(error));
@@ -69,10 +78,34 @@ PartitionModel::PartitionModel(QObject *parent)
     connect(m_manager.data(), &PartitionManagerPrivate::formatError, this, [this](Partition::Error error) {
         emit formatError(static_cast<PartitionModel::Error>(error));
     });
+
+    connect(m_manager.data(), &PartitionManagerPrivate::trimmed, this,
+            [this](const Partition &partition, qint64 bytesTrimmed, qint64 duration) {
+        emit trimmed(partition.devicePath(), bytesTrimmed, duration);
+    });
+    connect(m_manager.data(), &PartitionManagerPrivate::trimError, this, [this](Partition::Error error) {
+        emit trimError(static_cast<PartitionModel::Error>(error));
+    });
+    connect(m_manager.data(), &PartitionManagerPrivate::encryptionBenchmarkFinished,
+            this, &PartitionModel::encryptionBenchmarkFinished);
+
+    connect(m_manager.data(), &PartitionManagerPrivate::ejectProgress, this, &PartitionModel::ejectProgress);
+    connect(m_manager.data(), &PartitionManagerPrivate::ejectStepFinished, this,
+            [this](const QString &devicePath, Partition::EjectStep step, qint64 duration) {
+        emit ejectStepFinished(devicePath, static_cast<PartitionModel::EjectStep>(step), duration);
+    });
+    connect(m_manager.data(), &PartitionManagerPrivate::ejected, this, &PartitionModel::ejected);
+    connect(m_manager.data(), &PartitionManagerPrivate::ejectError, this,
+            [this](const QString &devicePath, Partition::Error error) {
+        emit ejectError(devicePath, static_cast<PartitionModel::Error>(error));
+    });
 }
 
 PartitionModel::~PartitionModel()
 {
+    if (m_ioStatisticsEnabled) {
+        m_manager->unsubscribeIoStatistics();
+    }
 }
 
 PartitionModel::StorageTypes PartitionModel::storageTypes() const
@@ -114,6 +147,46 @@ bool PartitionModel::externalStoragesPopulated() const
     return m_manager->externalStoragesPopulated();
 }
 
+bool PartitionModel::populating() const
+{
+    return m_manager->populating();
+}
+
+QVariantMap PartitionModel::readinessTimes() const
+{
+    return m_manager->readinessTimes();
+}
+
+bool PartitionModel::idleTrimEnabled() const
+{
+    return m_manager->idleTrimEnabled();
+}
+
+void PartitionModel::setIdleTrimEnabled(bool enabled)
+{
+    m_manager->setIdleTrimEnabled(enabled);
+}
+
+bool PartitionModel::ioStatisticsEnabled() const
+{
+    return m_ioStatisticsEnabled;
+}
+
+void PartitionModel::setIoStatisticsEnabled(bool enabled)
+{
+    if (m_ioStatisticsEnabled == enabled) {
+        return;
+    }
+
+    m_ioStatisticsEnabled = enabled;
+    if (enabled) {
+        m_manager->subscribeIoStatistics();
+    } else {
+        m_manager->unsubscribeIoStatistics();
+    }
+    emit ioStatisticsEnabledChanged();
+}
+
 void PartitionModel::refresh()
 {
     m_manager->scheduleRefresh();
@@ -144,9 +217,14 @@ void PartitionModel::unlock(const QString &devicePath, const QString &passphrase
 
 void PartitionModel::mount(const QString &devicePath)
 {
-    qCInfo(lcMemoryCardLog) << Q_FUNC_INFO << devicePath << m_partitions.count();
+    mount(devicePath, MountProfileFlash);
+}
+
+void PartitionModel::mount(const QString &devicePath, MountProfile profile)
+{
+    qCInfo(lcMemoryCardLog) << Q_FUNC_INFO << devicePath << profile << m_partitions.count();
     if (const Partition *partition = getPartition(devicePath)) {
-        m_manager->mount(*partition);
+        m_manager->mount(*partition, static_cast<Partition::MountProfile>(profile));
     } else {
         qCWarning(lcMemoryCardLog) << "Unable to mount unknown device:" << devicePath;
     }
@@ -162,6 +240,16 @@ void PartitionModel::unmount(const QString &devicePath)
     }
 }
 
+void PartitionModel::eject(const QString &devicePath)
+{
+    qCInfo(lcMemoryCardLog) << Q_FUNC_INFO << devicePath << m_partitions.count();
+    if (const Partition *partition = getPartition(devicePath)) {
+        m_manager->eject(*partition);
+    } else {
+        qCWarning(lcMemoryCardLog) << "Unable to eject unknown device:" << devicePath;
+    }
+}
+
 void PartitionModel::format(const QString &devicePath, const QVariantMap &arguments)
 {
     QString filesystemType = arguments.value(QLatin1String("filesystemType"), QString()).toString();
@@ -183,18 +271,57 @@ void PartitionModel::format(const QString &devicePath, const QVariantMap &argume
     QString passphrase = arguments.value(QLatin1String("encrypt-passphrase"), QString()).toString();
     if (!passphrase.isEmpty()) {
         args.insert(QLatin1String("encrypt.passphrase"), passphrase);
+
+        // luks1 or luks2, e.g. the encrypt-type recommended by benchmarkEncryption().
+        const QString encryptType = arguments.value(QLatin1String("encrypt-type"), QString()).toString();
+        if (!encryptType.isEmpty()) {
+            args.insert(QLatin1String("encrypt.type"), encryptType);
+        }
+    }
+
+    // flash-preset derives the mkfs parameters from the erase block and discard support of the device.
+    QStringList mkfsArgs;
+    if (arguments.value(QLatin1String("flash-preset"), false).toBool()) {
+        const QVariantMap preset = formatPreset(devicePath, filesystemType);
+        if (!preset.value(QLatin1String("aligned"), true).toBool()) {
+            qmlInfo(this) << devicePath << " is not aligned to the erase block, random writes will be slow.";
+        }
+        mkfsArgs = preset.value(QLatin1String("mkfs-args")).toStringList();
     }
 
-    QString mkfsArgs = arguments.value(QLatin1String("mkfs-args"), QString()).toString();
+    // Either a single argument or a list of them, appended after the preset so that they take precedence.
+    QStringList extraMkfsArgs = arguments.value(QLatin1String("mkfs-args")).toStringList();
+    extraMkfsArgs.removeAll(QString());
+    mkfsArgs += extraMkfsArgs;
+
     if (!mkfsArgs.isEmpty()) {
-        // assuming just one argument
-        args.insert(QLatin1String("mkfs-args"), QStringList() << mkfsArgs);
+        args.insert(QLatin1String("mkfs-args"), mkfsArgs);
     }
 
     qCInfo(lcMemoryCardLog) << Q_FUNC_INFO << devicePath << filesystemType << args << m_partitions.count();
     m_manager->format(devicePath, filesystemType, args);
 }
 
+QVariantMap PartitionModel::formatPreset(const QString &devicePath, const QString &filesystemType) const
+{
+    return m_manager->formatPreset(devicePath, filesystemType);
+}
+
+void PartitionModel::benchmarkEncryption(int targetUnlockTime)
+{
+    m_manager->benchmarkEncryption(targetUnlockTime);
+}
+
+void PartitionModel::trim(const QString &devicePath)
+{
+    qCInfo(lcMemoryCardLog) << Q_FUNC_INFO << devicePath << m_partitions.count();
+    if (const Partition *partition = getPartition(devicePath)) {
+        m_manager->trim(*partition);
+    } else {
+        qCWarning(lcMemoryCardLog) << "Unable to trim unknown device:" << devicePath;
+    }
+}
+
 QString PartitionModel::objectPath(const QString &devicePath) const
 {
     qCInfo(lcMemoryCardLog) << Q_FUNC_INFO << devicePath;
@@ -276,6 +403,19 @@ QHash<int, QByteArray> PartitionModel::roleNames() const
         { IsEncryptedRoles, "isEncrypted"},
         { CryptoBackingDevicePath, "cryptoBackingDevicePath"},
         { DriveRole, "drive"},
+        { ReadBytesPerSecondRole, "readBytesPerSecond"},
+        { WriteBytesPerSecondRole, "writeBytesPerSecond"},
+        { ReadOperationsPerSecondRole, "readOperationsPerSecond"},
+        { WriteOperationsPerSecondRole, "writeOperationsPerSecond"},
+        { RequestsInFlightRole, "requestsInFlight"},
+        { UtilizationRole, "utilization"},
+        { LifeTimeEstimateRole, "lifeTimeEstimate"},
+        { PreEolInfoRole, "preEolInfo"},
+        { FilesystemBytesWrittenRole, "filesystemBytesWritten"},
+        { BytesWrittenSinceBootRole, "bytesWrittenSinceBoot"},
+        { BytesWrittenRole, "bytesWritten"},
+        { WritebackMaxRatioRole, "writebackMaxRatio"},
+        { WritebackStrictLimitRole, "writebackStrictLimit"},
     };
 
     return roleNames;
@@ -332,6 +472,32 @@ QVariant PartitionModel::data(const QModelIndex &index, int role) const
             return partition.cryptoBackingDevicePath();
         case DriveRole:
             return partition.drive();
+        case ReadBytesPerSecondRole:
+            return partition.readBytesPerSecond();
+        case WriteBytesPerSecondRole:
+            return partition.writeBytesPerSecond();
+        case ReadOperationsPerSecondRole:
+            return partition.readOperationsPerSecond();
+        case WriteOperationsPerSecondRole:
+            return partition.writeOperationsPerSecond();
+        case RequestsInFlightRole:
+            return partition.requestsInFlight();
+        case UtilizationRole:
+            return partition.utilization();
+        case LifeTimeEstimateRole:
+            return partition.lifeTimeEstimate();
+        case PreEolInfoRole:
+            return partition.preEolInfo();
+        case FilesystemBytesWrittenRole:
+            return partition.filesystemBytesWritten();
+        case BytesWrittenSinceBootRole:
+            return partition.bytesWrittenSinceBoot();
+        case BytesWrittenRole:
+            return partition.bytesWritten();
+        case WritebackMaxRatioRole:
+            return partition.writebackMaxRatio();
+        case WritebackStrictLimitRole:
+            return partition.writebackStrictLimit();
         default:
             return QVariant();
         }
@@ -46,6 +46,10 @@ class SYSTEMSETTINGS_EXPORT PartitionModel : public QAbstractListModel
     Q_PROPERTY(StorageTypes storageTypes READ storageTypes WRITE setStorageTypes NOTIFY storageTypesChanged)
     Q_PROPERTY(QStringList supportedFormatTypes READ supportedFormatTypes CONSTANT)
     Q_PROPERTY(bool externalStoragesPopulated READ externalStoragesPopulated NOTIFY externalStoragesPopulatedChanged)
+    Q_PROPERTY(bool populating READ populating NOTIFY populatingChanged)
+    Q_PROPERTY(QVariantMap readinessTimes READ readinessTimes NOTIFY readinessTimesChanged)
+    Q_PROPERTY(bool idleTrimEnabled READ idleTrimEnabled WRITE setIdleTrimEnabled NOTIFY idleTrimEnabledChanged)
+    Q_PROPERTY(bool ioStatisticsEnabled READ ioStatisticsEnabled WRITE setIoStatisticsEnabled NOTIFY ioStatisticsEnabledChanged)
 
 public:
     enum {
@@ -68,6 +72,19 @@ public:
         IsEncryptedRoles,
         CryptoBackingDevicePath,
         DriveRole,
+        ReadBytesPerSecondRole,
+        WriteBytesPerSecondRole,
+        ReadOperationsPerSecondRole,
+        WriteOperationsPerSecondRole,
+        RequestsInFlightRole,
+        UtilizationRole,
+        LifeTimeEstimateRole,
+        PreEolInfoRole,
+        FilesystemBytesWrittenRole,
+        BytesWrittenSinceBootRole,
+        BytesWrittenRole,
+        WritebackMaxRatioRole,
+        WritebackStrictLimitRole,
     };
 
     // For Status role
@@ -124,6 +141,29 @@ public:
     };
     Q_ENUM(Error)
 
+    enum EjectStep {
+        EjectFlush      = Partition::EjectFlush,
+        EjectUnmount    = Partition::EjectUnmount,
+        EjectLock       = Partition::EjectLock,
+        EjectPowerOff   = Partition::EjectPowerOff
+    };
+    Q_ENUM(EjectStep)
+
+    enum PreEolInfo {
+        PreEolUndefined = Partition::PreEolUndefined,
+        PreEolNormal    = Partition::PreEolNormal,
+        PreEolWarning   = Partition::PreEolWarning,
+        PreEolUrgent    = Partition::PreEolUrgent
+    };
+    Q_ENUM(PreEolInfo)
+
+    enum MountProfile {
+        MountProfileFlash   = Partition::MountProfileFlash,
+        MountProfileDurable = Partition::MountProfileDurable,
+        MountProfileNone    = Partition::MountProfileNone
+    };
+    Q_ENUM(MountProfile)
+
     Q_DECLARE_FLAGS(StorageTypes, StorageType)
 
     explicit PartitionModel(QObject *parent = 0);
@@ -135,14 +175,32 @@ public:
     QStringList supportedFormatTypes() const;
     bool externalStoragesPopulated() const;
 
+    bool populating() const;
+    QVariantMap readinessTimes() const;
+
+    bool idleTrimEnabled() const;
+    void setIdleTrimEnabled(bool enabled);
+
+    bool ioStatisticsEnabled() const;
+    void setIoStatisticsEnabled(bool enabled);
+
     Q_INVOKABLE void refresh();
     Q_INVOKABLE void refresh(int index);
 
     Q_INVOKABLE void lock(const QString &devicePath);
     Q_INVOKABLE void unlock(const QString &devicePath, const QString &passphrase);
     Q_INVOKABLE void mount(const QString &devicePath);
+    Q_INVOKABLE void mount(const QString &devicePath, MountProfile profile);
     Q_INVOKABLE void unmount(const QString &devicePath);
+    Q_INVOKABLE void eject(const QString &devicePath);
     Q_INVOKABLE void format(const QString &devicePath, const QVariantMap &arguments);
+    // "aligned" is only present when the device reports its erase block.
+    Q_INVOKABLE QVariantMap formatPreset(const QString &devicePath, const QString &filesystemType) const;
+    // FITRIM requires CAP_SYS_ADMIN and is run by the setuid storagetrim helper for members of
+    // the users group, others get trimError(ErrorNotAuthorized).
+    Q_INVOKABLE void trim(const QString &devicePath);
+    // The target unlock time has no effect when luks2 is recommended, cryptsetup sizes Argon2id itself.
+    Q_INVOKABLE void benchmarkEncryption(int targetUnlockTime = 2000);
 
     Q_INVOKABLE QString objectPath(const QString &devicePath) const;
 
@@ -155,13 +213,27 @@ signals:
     void countChanged();
     void storageTypesChanged();
     void externalStoragesPopulatedChanged();
+    void populatingChanged();
+    void readinessTimesChanged();
+    void idleTrimEnabledChanged();
+    void ioStatisticsEnabledChanged();
 
     void errorMessage(const QString &objectPath, const QString &errorName);
     void lockError(Error error);
     void unlockError(Error error);
+    // The duration includes the time spent in a polkit authentication prompt, if any.
+    void unlocked(const QString &devicePath, qint64 duration);
     void mountError(Error error);
     void unmountError(Error error);
     void formatError(Error error);
+    void trimmed(const QString &devicePath, qint64 bytesTrimmed, qint64 duration);
+    void trimError(Error error);
+    void encryptionBenchmarkFinished(const QVariantMap &recommendation);
+
+    void ejectProgress(const QString &devicePath, qint64 dirtyBytes, qint64 writebackBytes);
+    void ejectStepFinished(const QString &devicePath, EjectStep step, qint64 duration);
+    void ejected(const QString &devicePath, qint64 duration);
+    void ejectError(const QString &devicePath, Error error);
 
 private:
     void update();
@@ -175,6 +247,7 @@ private:
     QExplicitlySharedDataPointer<PartitionManagerPrivate> m_manager;
     QVector<Partition> m_partitions;
     StorageTypes m_storageTypes;
+    bool m_ioStatisticsEnabled;
 };
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(PartitionModel::StorageTypes)
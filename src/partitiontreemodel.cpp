@@ -0,0 +1,555 @@
+/*
+ * Copyright (C) 2026 Nemo Mobile Project
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include "partitiontreemodel.h"
+#include "partitionmanager_p.h"
+#include "sysfsblock_p.h"
+
+#include <algorithm>
+
+class PartitionTreeNode
+{
+public:
+    explicit PartitionTreeNode(PartitionTreeModel::NodeType type, PartitionTreeNode *parent = nullptr)
+        : type(type)
+        , parent(parent)
+        , fetched(false)
+    {
+    }
+
+    ~PartitionTreeNode()
+    {
+        qDeleteAll(children);
+    }
+
+    int row() const
+    {
+        return parent ? parent->children.indexOf(const_cast<PartitionTreeNode *>(this)) : 0;
+    }
+
+    PartitionTreeNode *find(const Partition &partition)
+    {
+        if (this->partition == partition) {
+            return this;
+        }
+        for (PartitionTreeNode *child : children) {
+            if (PartitionTreeNode *node = child->find(partition)) {
+                return node;
+            }
+        }
+        return nullptr;
+    }
+
+    PartitionTreeNode *findByDevicePath(const QString &devicePath)
+    {
+        if (type == PartitionTreeModel::PartitionNode && partition.devicePath() == devicePath) {
+            return this;
+        }
+        for (PartitionTreeNode *child : children) {
+            if (PartitionTreeNode *node = child->findByDevicePath(devicePath)) {
+                return node;
+            }
+        }
+        return nullptr;
+    }
+
+    PartitionTreeNode *table() const
+    {
+        for (PartitionTreeNode *child : children) {
+            if (child->type == PartitionTreeModel::PartitionTableNode) {
+                return child;
+            }
+        }
+        return nullptr;
+    }
+
+    PartitionTreeModel::NodeType type;
+    PartitionTreeNode *parent;
+    QVector<PartitionTreeNode *> children;
+
+    // Kernel name of the disk for drive and partition table nodes.
+    QString diskName;
+    // The whole disk for drive nodes.
+    Partition partition;
+
+    // Partitions of a drive whose children have not been fetched yet.
+    QVector<Partition> pending;
+    bool fetched;
+};
+
+namespace {
+
+QString diskName(const Partition &partition)
+{
+    const QString name = SysfsBlock::kernelName(partition.devicePath());
+    return name.isEmpty() ? partition.deviceName() : SysfsBlock::diskName(name);
+}
+
+bool isWholeDisk(const Partition &partition, const QString &disk)
+{
+    return partition.cryptoBackingDevicePath().isEmpty()
+            && (SysfsBlock::kernelName(partition.devicePath()) == disk || partition.deviceName() == disk);
+}
+
+// Whole disks are listed as a partition of their own only when formatted without a partition table.
+bool hasFilesystem(const Partition &partition)
+{
+    return !partition.filesystemType().isEmpty() || partition.isEncrypted() || partition.isCryptoDevice();
+}
+
+}
+
+PartitionTreeModel::PartitionTreeModel(QObject *parent)
+    : QAbstractItemModel(parent)
+    , m_manager(PartitionManagerPrivate::instance())
+    , m_root(new PartitionTreeNode(DriveNode))
+    , m_storageTypes(PartitionModel::Any)
+{
+    populate();
+
+    connect(m_manager.data(), &PartitionManagerPrivate::partitionChanged, this, &PartitionTreeModel::partitionChanged);
+    connect(m_manager.data(), &PartitionManagerPrivate::partitionAdded, this, &PartitionTreeModel::partitionAdded);
+    connect(m_manager.data(), &PartitionManagerPrivate::partitionRemoved, this, &PartitionTreeModel::partitionRemoved);
+}
+
+PartitionTreeModel::~PartitionTreeModel()
+{
+    delete m_root;
+}
+
+int PartitionTreeModel::count() const
+{
+    return m_root->children.count();
+}
+
+PartitionModel::StorageTypes PartitionTreeModel::storageTypes() const
+{
+    return m_storageTypes;
+}
+
+void PartitionTreeModel::setStorageTypes(PartitionModel::StorageTypes types)
+{
+    if (m_storageTypes != types) {
+        const PartitionModel::StorageTypes previousTypes = m_storageTypes;
+        m_storageTypes = types;
+
+        QStringList disks;
+        QHash<QString, QVector<Partition>> diskPartitions;
+        const auto partitions = m_manager->partitions(Partition::Any);
+        for (const Partition &partition : partitions) {
+            const QString disk = diskName(partition);
+            if (!diskPartitions.contains(disk)) {
+                disks.append(disk);
+            }
+            diskPartitions[disk].append(partition);
+        }
+
+        // Only the drives with partitions that enter or leave the filter are rebuilt,
+        // the others keep their rows and fetched state.
+        for (const QString &disk : disks) {
+            const QVector<Partition> &drivePartitions = diskPartitions[disk];
+            const bool changed = std::any_of(drivePartitions.begin(), drivePartitions.end(),
+                                             [previousTypes, types](const Partition &partition) {
+                return bool(partition.storageType() & previousTypes) != bool(partition.storageType() & types);
+            });
+            if (!changed) {
+                continue;
+            }
+
+            if (PartitionTreeNode *drive = m_drives.take(disk)) {
+                removeNode(drive);
+                emit countChanged();
+            }
+            for (const Partition &partition : drivePartitions) {
+                addPartition(partition, true);
+            }
+        }
+
+        emit storageTypesChanged();
+    }
+}
+
+QHash<int, QByteArray> PartitionTreeModel::roleNames() const
+{
+    static const QHash<int, QByteArray> roleNames = {
+        { NodeTypeRole, "nodeType" },
+        { DiskNameRole, "diskName" },
+        { DriveRole, "drive" },
+        { StatusRole, "status" },
+        { StorageTypeRole, "storageType" },
+        { FilesystemTypeRole, "filesystemType" },
+        { DeviceLabelRole, "deviceLabel" },
+        { DevicePathRole, "devicePath" },
+        { DeviceNameRole, "deviceName" },
+        { MountPathRole, "mountPath" },
+        { BytesAvailableRole, "bytesAvailable" },
+        { BytesTotalRole, "bytesTotal" },
+        { BytesFreeRole, "bytesFree" },
+        { IsCryptoDeviceRole, "isCryptoDevice" },
+        { IsEncryptedRole, "isEncrypted" },
+        { CryptoBackingDevicePathRole, "cryptoBackingDevicePath" },
+    };
+
+    return roleNames;
+}
+
+QModelIndex PartitionTreeModel::index(int row, int column, const QModelIndex &parent) const
+{
+    PartitionTreeNode *parentNode = node(parent);
+    if (column != 0 || row < 0 || row >= parentNode->children.count()) {
+        return QModelIndex();
+    }
+    return createIndex(row, column, parentNode->children.at(row));
+}
+
+QModelIndex PartitionTreeModel::parent(const QModelIndex &index) const
+{
+    if (!index.isValid()) {
+        return QModelIndex();
+    }
+    return indexOf(node(index)->parent);
+}
+
+int PartitionTreeModel::rowCount(const QModelIndex &parent) const
+{
+    return node(parent)->children.count();
+}
+
+int PartitionTreeModel::columnCount(const QModelIndex &) const
+{
+    return 1;
+}
+
+bool PartitionTreeModel::hasChildren(const QModelIndex &parent) const
+{
+    const PartitionTreeNode *parentNode = node(parent);
+    return !parentNode->children.isEmpty() || !parentNode->pending.isEmpty();
+}
+
+QVariant PartitionTreeModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid()) {
+        return QVariant();
+    }
+
+    const PartitionTreeNode *item = node(index);
+    const Partition &partition = item->type == PartitionTableNode
+            ? item->parent->partition
+            : item->partition;
+
+    switch (role) {
+    case NodeTypeRole:
+        return item->type;
+    case DiskNameRole:
+        return item->type == PartitionNode ? QString() : item->diskName;
+    case DriveRole:
+        return item->type == DriveNode ? partition.drive() : QVariant();
+    }
+
+    // Partition tables have only the disk name, the rest describes the whole disk.
+    if (item->type == PartitionTableNode) {
+        return QVariant();
+    }
+
+    switch (role) {
+    case StatusRole:
+        return partition.status();
+    case StorageTypeRole:
+        return partition.storageType();
+    case FilesystemTypeRole:
+        return partition.filesystemType();
+    case DeviceLabelRole:
+        return partition.deviceLabel();
+    case DevicePathRole:
+        return partition.devicePath();
+    case DeviceNameRole:
+        return item->type == DriveNode ? item->diskName : partition.deviceName();
+    case MountPathRole:
+        return partition.mountPath();
+    case BytesAvailableRole:
+        return partition.bytesAvailable();
+    case BytesTotalRole:
+        return partition.bytesTotal();
+    case BytesFreeRole:
+        return partition.bytesFree();
+    case IsCryptoDeviceRole:
+        return partition.isCryptoDevice();
+    case IsEncryptedRole:
+        return partition.isEncrypted();
+    case CryptoBackingDevicePathRole:
+        return partition.cryptoBackingDevicePath();
+    default:
+        return QVariant();
+    }
+}
+
+bool PartitionTreeModel::canFetchMore(const QModelIndex &parent) const
+{
+    const PartitionTreeNode *parentNode = node(parent);
+    return parentNode->type == DriveNode && parentNode != m_root && !parentNode->fetched;
+}
+
+void PartitionTreeModel::fetchMore(const QModelIndex &parent)
+{
+    PartitionTreeNode *drive = node(parent);
+    if (drive->type != DriveNode || drive == m_root || drive->fetched) {
+        return;
+    }
+
+    // Build the subtree aside so that the rows appear in one insertion.
+    PartitionTreeNode subtree(DriveNode);
+    subtree.diskName = drive->diskName;
+    for (const Partition &partition : drive->pending) {
+        placePartition(&subtree, partition, false);
+    }
+    drive->pending.clear();
+    drive->fetched = true;
+
+    if (!subtree.children.isEmpty()) {
+        beginInsertRows(parent, 0, subtree.children.count() - 1);
+        drive->children.swap(subtree.children);
+        for (PartitionTreeNode *child : drive->children) {
+            child->parent = drive;
+        }
+        endInsertRows();
+    }
+}
+
+PartitionTreeNode *PartitionTreeModel::node(const QModelIndex &index) const
+{
+    return index.isValid() ? static_cast<PartitionTreeNode *>(index.internalPointer()) : m_root;
+}
+
+QModelIndex PartitionTreeModel::indexOf(PartitionTreeNode *node) const
+{
+    if (!node || node == m_root) {
+        return QModelIndex();
+    }
+    return createIndex(node->row(), 0, node);
+}
+
+void PartitionTreeModel::populate()
+{
+    const auto partitions = m_manager->partitions(Partition::Any);
+    for (const Partition &partition : partitions) {
+        addPartition(partition, false);
+    }
+}
+
+void PartitionTreeModel::addPartition(const Partition &partition, bool notify)
+{
+    if (!(partition.storageType() & m_storageTypes)) {
+        return;
+    }
+
+    const QString disk = diskName(partition);
+    PartitionTreeNode *drive = m_drives.value(disk);
+    if (!drive) {
+        drive = new PartitionTreeNode(DriveNode);
+        drive->diskName = disk;
+        m_drives.insert(disk, drive);
+        insertNode(m_root, drive, notify);
+        if (notify) {
+            emit countChanged();
+        }
+    }
+
+    if (isWholeDisk(partition, disk)) {
+        drive->partition = partition;
+        if (notify) {
+            const QModelIndex driveIndex = indexOf(drive);
+            emit dataChanged(driveIndex, driveIndex);
+        }
+        if (!hasFilesystem(partition)) {
+            return;
+        }
+    }
+
+    if (drive->fetched) {
+        placePartition(drive, partition, notify);
+    } else {
+        drive->pending.append(partition);
+    }
+}
+
+void PartitionTreeModel::placePartition(PartitionTreeNode *drive, const Partition &partition, bool notify)
+{
+    PartitionTreeNode *parent = nullptr;
+
+    const QString backingDevicePath = partition.cryptoBackingDevicePath();
+    if (!backingDevicePath.isEmpty()) {
+        parent = drive->findByDevicePath(backingDevicePath);
+    }
+
+    if (!parent) {
+        if (isWholeDisk(partition, drive->diskName)) {
+            parent = drive;
+        } else if (!(parent = drive->table())) {
+            parent = new PartitionTreeNode(PartitionTableNode);
+            parent->diskName = drive->diskName;
+            insertNode(drive, parent, notify);
+        }
+    }
+
+    PartitionTreeNode *child = new PartitionTreeNode(PartitionNode);
+    child->partition = partition;
+    insertNode(parent, child, notify);
+
+    // A crypto mapping may be reported before its backing partition, adopt it.
+    const QString devicePath = partition.devicePath();
+    for (int i = parent->children.count() - 1; i >= 0 && !devicePath.isEmpty(); --i) {
+        PartitionTreeNode *sibling = parent->children.at(i);
+        if (sibling == child || sibling->partition.cryptoBackingDevicePath() != devicePath) {
+            continue;
+        }
+
+        if (notify) {
+            beginMoveRows(indexOf(parent), i, i, indexOf(child), child->children.count());
+        }
+        parent->children.removeAt(i);
+        sibling->parent = child;
+        child->children.append(sibling);
+        if (notify) {
+            endMoveRows();
+        }
+    }
+}
+
+void PartitionTreeModel::insertNode(PartitionTreeNode *parent, PartitionTreeNode *child, bool notify)
+{
+    const int row = parent->children.count();
+
+    if (notify) {
+        beginInsertRows(indexOf(parent), row, row);
+    }
+    child->parent = parent;
+    parent->children.append(child);
+    if (notify) {
+        endInsertRows();
+    }
+}
+
+void PartitionTreeModel::removeNode(PartitionTreeNode *node)
+{
+    PartitionTreeNode *parent = node->parent;
+    const int row = node->row();
+
+    beginRemoveRows(indexOf(parent), row, row);
+    parent->children.removeAt(row);
+    endRemoveRows();
+
+    delete node;
+
+    if (parent->type == PartitionTableNode && parent->children.isEmpty()) {
+        removeNode(parent);
+    }
+}
+
+void PartitionTreeModel::pruneDrive(PartitionTreeNode *drive)
+{
+    if (drive->children.isEmpty() && drive->pending.isEmpty() && drive->partition == Partition()) {
+        m_drives.remove(drive->diskName);
+        removeNode(drive);
+        emit countChanged();
+    }
+}
+
+void PartitionTreeModel::partitionChanged(const Partition &partition)
+{
+    for (PartitionTreeNode *drive : m_root->children) {
+        if (drive->partition == partition) {
+            const QModelIndex driveIndex = indexOf(drive);
+            emit dataChanged(driveIndex, driveIndex);
+
+            // Formatting the whole disk adds or removes its file system.
+            if (drive->fetched) {
+                PartitionTreeNode *node = nullptr;
+                for (PartitionTreeNode *child : drive->children) {
+                    if (child->partition == partition) {
+                        node = child;
+                    }
+                }
+                if (node && !hasFilesystem(partition)) {
+                    removeNode(node);
+                } else if (!node && hasFilesystem(partition)) {
+                    placePartition(drive, partition, true);
+                }
+            } else if (drive->pending.contains(partition) != hasFilesystem(partition)) {
+                if (hasFilesystem(partition)) {
+                    drive->pending.append(partition);
+                } else {
+                    drive->pending.removeAll(partition);
+                }
+            }
+        }
+
+        // The whole disk can be both the drive and a partition of its own.
+        if (drive->fetched) {
+            for (PartitionTreeNode *child : drive->children) {
+                if (PartitionTreeNode *node = child->find(partition)) {
+                    const QModelIndex index = indexOf(node);
+                    emit dataChanged(index, index);
+                    return;
+                }
+            }
+        }
+    }
+}
+
+void PartitionTreeModel::partitionAdded(const Partition &partition)
+{
+    addPartition(partition, true);
+}
+
+void PartitionTreeModel::partitionRemoved(const Partition &partition)
+{
+    for (PartitionTreeNode *drive : m_root->children) {
+        bool found = drive->pending.removeAll(partition) > 0;
+
+        if (drive->partition == partition) {
+            drive->partition = Partition();
+            found = true;
+        }
+
+        for (PartitionTreeNode *child : drive->children) {
+            if (PartitionTreeNode *node = child->find(partition)) {
+                removeNode(node);
+                found = true;
+                break;
+            }
+        }
+
+        if (found) {
+            pruneDrive(drive);
+            return;
+        }
+    }
+}
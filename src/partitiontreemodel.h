@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2026 Nemo Mobile Project
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#ifndef PARTITIONTREEMODEL_H
+#define PARTITIONTREEMODEL_H
+
+#include <QAbstractItemModel>
+#include <QHash>
+
+#include <partitionmodel.h>
+
+class PartitionTreeNode;
+
+// Presents the partitions grouped by drive: drive -> partition table -> partitions,
+// with unlocked crypto mappings as children of their backing partitions. Whole disk
+// file systems without a partition table are direct children of the drive.
+class SYSTEMSETTINGS_EXPORT PartitionTreeModel : public QAbstractItemModel
+{
+    Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+    Q_PROPERTY(PartitionModel::StorageTypes storageTypes READ storageTypes WRITE setStorageTypes NOTIFY storageTypesChanged)
+
+public:
+    enum {
+        NodeTypeRole = Qt::UserRole + 1,
+        DiskNameRole,
+        DriveRole,
+        StatusRole,
+        StorageTypeRole,
+        FilesystemTypeRole,
+        DeviceLabelRole,
+        DevicePathRole,
+        DeviceNameRole,
+        MountPathRole,
+        BytesAvailableRole,
+        BytesTotalRole,
+        BytesFreeRole,
+        IsCryptoDeviceRole,
+        IsEncryptedRole,
+        CryptoBackingDevicePathRole
+    };
+
+    enum NodeType {
+        DriveNode,
+        PartitionTableNode,
+        PartitionNode
+    };
+    Q_ENUM(NodeType)
+
+    explicit PartitionTreeModel(QObject *parent = nullptr);
+    ~PartitionTreeModel();
+
+    // Number of drives
+    int count() const;
+
+    PartitionModel::StorageTypes storageTypes() const;
+    void setStorageTypes(PartitionModel::StorageTypes storageTypes);
+
+    QHash<int, QByteArray> roleNames() const;
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const;
+    QModelIndex parent(const QModelIndex &index) const;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const;
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role) const;
+
+    bool canFetchMore(const QModelIndex &parent) const;
+    void fetchMore(const QModelIndex &parent);
+
+signals:
+    void countChanged();
+    void storageTypesChanged();
+
+private:
+    PartitionTreeNode *node(const QModelIndex &index) const;
+    QModelIndex indexOf(PartitionTreeNode *node) const;
+
+    void populate();
+    void addPartition(const Partition &partition, bool notify);
+    void placePartition(PartitionTreeNode *drive, const Partition &partition, bool notify);
+    void insertNode(PartitionTreeNode *parent, PartitionTreeNode *child, bool notify);
+    void removeNode(PartitionTreeNode *node);
+    void pruneDrive(PartitionTreeNode *drive);
+
+    void partitionChanged(const Partition &partition);
+    void partitionAdded(const Partition &partition);
+    void partitionRemoved(const Partition &partition);
+
+    QExplicitlySharedDataPointer<PartitionManagerPrivate> m_manager;
+    PartitionTreeNode *m_root;
+    QHash<QString, PartitionTreeNode *> m_drives;
+    PartitionModel::StorageTypes m_storageTypes;
+};
+
+#endif
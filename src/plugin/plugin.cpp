@@ -49,6 +49,10 @@
 #endif
 #include "batterystatus.h"
 #include "partitionmodel.h"
+#include "partitiontreemodel.h"
+#include "cacheusagemodel.h"
+#include "certificateaudit.h"
+#include "certificatefiltermodel.h"
 #include "certificatemodel.h"
 #include "locationsettings.h"
 #include "deviceinfo.h"
@@ -101,12 +105,16 @@ public:
         qmlRegisterType<QUsbModed>(uri, 1, 0, "USBSettings");
         qmlRegisterType<AboutSettings>(uri, 1, 0, "AboutSettings");
         qmlRegisterType<PartitionModel>(uri, 1, 0, "PartitionModel");
+        qmlRegisterType<PartitionTreeModel>(uri, 1, 0, "PartitionTreeModel");
         qRegisterMetaType<Partition>("Partition");
 #ifdef DEVELOPER_MODE_ENABLED
         qmlRegisterType<DeveloperModeSettings>(uri, 1, 0, "DeveloperModeSettings");
         qRegisterMetaType<DeveloperModeSettings::Status>("DeveloperModeSettings::Status");
 #endif
         qmlRegisterType<CertificateModel>(uri, 1, 0, "CertificateModel");
+        qmlRegisterType<CertificateAudit>(uri, 1, 0, "CertificateAudit");
+        qmlRegisterType<CertificateFilterModel>(uri, 1, 0, "CertificateFilterModel");
+        qmlRegisterType<CacheUsageModel>(uri, 1, 0, "CacheUsageModel");
         qmlRegisterType<BatteryStatus>(uri, 1, 0, "BatteryStatus");
         qmlRegisterType<LocationSettings>(uri, 1, 0, "LocationSettings");
         qmlRegisterType<DeviceInfo>(uri, 1, 0, "DeviceInfo");
@@ -53,18 +53,35 @@ SOURCES += \
     mceiface.cpp \
     displaysettings.cpp \
     aboutsettings.cpp \
+    cacheusagemodel.cpp \
     certificatemodel.cpp \
     batterystatus.cpp \
+    certificateaudit.cpp \
+    certificatecache.cpp \
+    certificatefiltermodel.cpp \
+    certificatestore.cpp \
+    bdi.cpp \
     partition.cpp \
     partitionmanager.cpp \
     partitionmodel.cpp \
+    partitiontreemodel.cpp \
+    storagemetrics.cpp \
+    storagepolicy.cpp \
+    sysfsblock.cpp \
     deviceinfo.cpp \
+    diskquota.cpp \
+    iostatssampler.cpp \
+    luksbenchmark.cpp \
+    directorysize.cpp \
     locationsettings.cpp \
     timezoneinfo.cpp \
+    trimscheduler.cpp \
     udisks2block.cpp \
     udisks2blockdevices.cpp \
     udisks2job.cpp \
     udisks2monitor.cpp \
+    ueventmonitor.cpp \
+    weartelemetry.cpp \
     permissionsmodel.cpp
 
 PUBLIC_HEADERS = \
@@ -75,6 +92,9 @@ PUBLIC_HEADERS = \
     mceiface.h \
     displaysettings.h \
     aboutsettings.h \
+    cacheusagemodel.h \
+    certificateaudit.h \
+    certificatefiltermodel.h \
     certificatemodel.h \
     batterystatus.h \
     udisks2block_p.h \
@@ -82,6 +102,7 @@ PUBLIC_HEADERS = \
     partition.h \
     partitionmanager.h \
     partitionmodel.h \
+    partitiontreemodel.h \
     systemsettingsglobal.h \
     deviceinfo.h \
     locationsettings.h \
@@ -93,15 +114,29 @@ HEADERS += \
     aboutsettings_p.h \
     localeconfig.h \
     batterystatus_p.h \
+    bdi_p.h \
+    certificatecache_p.h \
+    certificatemodel_p.h \
+    certificatestore_p.h \
+    diskquota_p.h \
+    iostatssampler_p.h \
+    luksbenchmark_p.h \
+    directorysize_p.h \
     logging_p.h \
     locationsettings_p.h \
     logging_p.h \
     nfcsettings.h \
     partition_p.h \
     partitionmanager_p.h \
+    storagemetrics_p.h \
+    storagepolicy_p.h \
+    sysfsblock_p.h \
+    trimscheduler_p.h \
     udisks2blockdevices_p.h \
     udisks2job_p.h \
-    udisks2monitor_p.h
+    udisks2monitor_p.h \
+    ueventmonitor_p.h \
+    weartelemetry_p.h
 
 CONFIG(DEVELOPER_MODE_ENABLED) {
     SOURCES += developermodesettings.cpp
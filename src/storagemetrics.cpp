@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2026 Nemo Mobile Project
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include "storagemetrics_p.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+
+#include <algorithm>
+
+namespace {
+
+struct Timing
+{
+    qint64 count = 0;
+    qint64 total = 0;
+    qint64 max = 0;
+    qint64 last = 0;
+};
+
+QMutex metricsMutex;
+QHash<QString, qint64> counters;
+QHash<QString, Timing> timings;
+
+}
+
+void StorageMetrics::count(const QString &name, qint64 value)
+{
+    QMutexLocker locker(&metricsMutex);
+    counters[name] += value;
+}
+
+void StorageMetrics::time(const QString &name, qint64 milliseconds)
+{
+    QMutexLocker locker(&metricsMutex);
+    Timing &timing = timings[name];
+    timing.count += 1;
+    timing.total += milliseconds;
+    timing.max = std::max(timing.max, milliseconds);
+    timing.last = milliseconds;
+}
+
+QVariantMap StorageMetrics::snapshot()
+{
+    QMutexLocker locker(&metricsMutex);
+
+    QVariantMap counterValues;
+    for (auto it = counters.constBegin(); it != counters.constEnd(); ++it) {
+        counterValues.insert(it.key(), it.value());
+    }
+
+    QVariantMap timingValues;
+    for (auto it = timings.constBegin(); it != timings.constEnd(); ++it) {
+        QVariantMap timing;
+        timing.insert(QStringLiteral("count"), it->count);
+        timing.insert(QStringLiteral("total"), it->total);
+        timing.insert(QStringLiteral("max"), it->max);
+        timing.insert(QStringLiteral("last"), it->last);
+        timingValues.insert(it.key(), timing);
+    }
+
+    QVariantMap metrics;
+    metrics.insert(QStringLiteral("counters"), counterValues);
+    metrics.insert(QStringLiteral("timings"), timingValues);
+    return metrics;
+}
+
+void StorageMetrics::reset()
+{
+    QMutexLocker locker(&metricsMutex);
+    counters.clear();
+    timings.clear();
+}
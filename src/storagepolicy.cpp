@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2026 Nemo Mobile Project
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include "storagepolicy_p.h"
+#include "partition_p.h"
+#include "bdi_p.h"
+#include "sysfsblock_p.h"
+#include "logging_p.h"
+
+#include <QSettings>
+
+namespace {
+
+const QString PolicyFile = QStringLiteral("/etc/nemo-systemsettings/storage-policy.ini");
+
+bool setQueueAttribute(const QString &disk, const QString &attribute, const QByteArray &value)
+{
+    const QString path = QStringLiteral("queue/") + attribute;
+    if (SysfsBlock::readAttribute(disk, path) == value) {
+        return true;
+    }
+    return SysfsBlock::writeAttribute(disk, path, value);
+}
+
+}
+
+StoragePolicy::StoragePolicy()
+{
+    // Larger read-ahead keeps media playback from USB sticks and cards streaming.
+    // Slow removable media may only hold a tenth of the dirty page cache so that
+    // large copies to them don't stall writers to the internal storage.
+    Tuning sdio;
+    sdio.readAheadKb = 512;
+    sdio.maxRatio = 10;
+    sdio.strictLimit = 1;
+    m_tunings.insert(groupName(Partition::SDIO, false), sdio);
+
+    Tuning usb;
+    usb.readAheadKb = 1024;
+    usb.maxRatio = 10;
+    usb.strictLimit = 1;
+    m_tunings.insert(groupName(Partition::USB, false), usb);
+
+    // Hard disks are still removable, keep their dirty page cache share limited as well.
+    Tuning rotational = usb;
+    rotational.readAheadKb = 2048;
+    rotational.scheduler = QStringLiteral("mq-deadline");
+    m_tunings.insert(groupName(Partition::USB, true), rotational);
+    m_tunings.insert(groupName(Partition::IEEE1394, true), rotational);
+
+    QSettings settings(PolicyFile, QSettings::IniFormat);
+    for (const QString &group : settings.childGroups()) {
+        settings.beginGroup(group);
+        Tuning &tuning = m_tunings[group];
+        tuning.readAheadKb = settings.value(QStringLiteral("read_ahead_kb"), tuning.readAheadKb).toInt();
+        tuning.requests = settings.value(QStringLiteral("nr_requests"), tuning.requests).toInt();
+        tuning.scheduler = settings.value(QStringLiteral("scheduler"), tuning.scheduler).toString();
+        tuning.maxRatio = settings.value(QStringLiteral("max_ratio"), tuning.maxRatio).toInt();
+        tuning.strictLimit = settings.value(QStringLiteral("strict_limit"), tuning.strictLimit).toInt();
+        settings.endGroup();
+    }
+}
+
+StoragePolicy::Tuning StoragePolicy::tuning(Partition::ConnectionBus bus, bool rotational) const
+{
+    if (rotational) {
+        const auto it = m_tunings.constFind(groupName(bus, true));
+        if (it != m_tunings.constEnd()) {
+            return *it;
+        }
+    }
+    return m_tunings.value(groupName(bus, false));
+}
+
+void StoragePolicy::apply(PartitionPrivate *partition) const
+{
+    const QString disk = SysfsBlock::diskName(SysfsBlock::kernelName(partition->devicePath, false));
+    if (disk.isEmpty()) {
+        return;
+    }
+
+    const auto bus = static_cast<Partition::ConnectionBus>(
+                partition->drive.value(QLatin1String("connectionBus")).toInt());
+    const bool rotational = SysfsBlock::readNumber(disk, QStringLiteral("queue/rotational")) != 0;
+    const Tuning policy = tuning(bus, rotational);
+
+    qCInfo(lcMemoryCardLog) << "Applying storage policy to" << disk << "read_ahead_kb:" << policy.readAheadKb
+                            << "nr_requests:" << policy.requests << "scheduler:" << policy.scheduler
+                            << "max_ratio:" << policy.maxRatio << "strict_limit:" << policy.strictLimit;
+
+    // The scheduler resets nr_requests, set it first.
+    if (!policy.scheduler.isEmpty()) {
+        // The active scheduler is listed in brackets, e.g. "[none] mq-deadline kyber".
+        const QList<QByteArray> available = SysfsBlock::readAttribute(disk, QStringLiteral("queue/scheduler")).split(' ');
+        const QByteArray scheduler = policy.scheduler.toLatin1();
+        if (available.contains(scheduler)) {
+            SysfsBlock::writeAttribute(disk, QStringLiteral("queue/scheduler"), scheduler);
+        } else if (!available.contains('[' + scheduler + ']')) {
+            qCWarning(lcMemoryCardLog) << "I/O scheduler" << policy.scheduler << "not available for" << disk;
+        }
+    }
+    if (policy.requests > 0) {
+        setQueueAttribute(disk, QStringLiteral("nr_requests"), QByteArray::number(policy.requests));
+    }
+    if (policy.readAheadKb >= 0) {
+        setQueueAttribute(disk, QStringLiteral("read_ahead_kb"), QByteArray::number(policy.readAheadKb));
+    }
+
+    // The BDI of a partition is the one of its disk, named by the disk's major:minor.
+    const QString bdi = QString::fromLatin1(SysfsBlock::readAttribute(disk, QStringLiteral("dev")));
+    if (bdi.isEmpty()) {
+        return;
+    }
+
+    if (policy.maxRatio >= 0 && Bdi::readAttribute(bdi, QStringLiteral("max_ratio")).toInt() != policy.maxRatio) {
+        Bdi::writeAttribute(bdi, QStringLiteral("max_ratio"), QByteArray::number(policy.maxRatio));
+    }
+    if (policy.strictLimit >= 0
+            && Bdi::readAttribute(bdi, QStringLiteral("strict_limit")).toInt() != policy.strictLimit) {
+        Bdi::writeAttribute(bdi, QStringLiteral("strict_limit"), QByteArray::number(policy.strictLimit));
+    }
+
+    // Report what is in effect, writes fail without privileges.
+    bool ok = false;
+    const int maxRatio = Bdi::readAttribute(bdi, QStringLiteral("max_ratio")).toInt(&ok);
+    partition->writebackMaxRatio = ok ? maxRatio : -1;
+    partition->writebackStrictLimit = Bdi::readAttribute(bdi, QStringLiteral("strict_limit")).toInt() != 0;
+}
+
+QString StoragePolicy::groupName(Partition::ConnectionBus bus, bool rotational)
+{
+    QString name;
+    switch (bus) {
+    case Partition::SDIO:
+        name = QStringLiteral("sdio");
+        break;
+    case Partition::USB:
+        name = QStringLiteral("usb");
+        break;
+    case Partition::IEEE1394:
+        name = QStringLiteral("ieee1394");
+        break;
+    default:
+        name = QStringLiteral("unknown");
+        break;
+    }
+
+    return rotational ? name + QStringLiteral("-rotational") : name;
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2026 Nemo Mobile Project
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#ifndef STORAGEPOLICY_P_H
+#define STORAGEPOLICY_P_H
+
+#include <QHash>
+#include <QString>
+
+#include "partition.h"
+
+class PartitionPrivate;
+
+// Block queue and writeback tuning applied to external media when they appear.
+//
+// Defaults can be overridden in /etc/nemo-systemsettings/storage-policy.ini with
+// groups named after the bus (sdio, usb, ieee1394, unknown), optionally suffixed
+// with -rotational to target spinning disks, e.g.
+//
+// [usb]
+// read_ahead_kb=2048
+// nr_requests=64
+// scheduler=mq-deadline
+// max_ratio=10
+// strict_limit=1
+//
+// max_ratio and strict_limit limit the share of the dirty page cache a single
+// slow device may hold, see /sys/class/bdi in the kernel ABI documentation.
+// A value of -1 leaves the kernel default in place.
+class StoragePolicy
+{
+public:
+    struct Tuning
+    {
+        int readAheadKb = -1;
+        int requests = -1;
+        QString scheduler;
+        int maxRatio = -1;
+        int strictLimit = -1;
+    };
+
+    StoragePolicy();
+
+    Tuning tuning(Partition::ConnectionBus bus, bool rotational) const;
+    // Applies the tuning to the disk of the partition and records the writeback limits in effect.
+    void apply(PartitionPrivate *partition) const;
+
+private:
+    static QString groupName(Partition::ConnectionBus bus, bool rotational);
+
+    QHash<QString, Tuning> m_tunings;
+};
+
+#endif
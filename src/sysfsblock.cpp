@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2026 Nemo Mobile Project
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include "sysfsblock_p.h"
+#include "logging_p.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+#include <algorithm>
+
+namespace {
+
+const QString SysClassBlock = QStringLiteral("/sys/class/block/");
+
+const quint64 DefaultEraseBlockSize = 4 * 1024 * 1024;
+
+}
+
+quint64 SysfsBlock::Geometry::eraseBlockSize() const
+{
+    const quint64 size = std::max(std::max(preferredEraseSize, discardGranularity), optimalIoSize);
+    return size > 0 ? size : DefaultEraseBlockSize;
+}
+
+QString SysfsBlock::kernelName(const QString &devicePath, bool followDeviceMapper)
+{
+    QString name = QFileInfo(QFileInfo(devicePath).canonicalFilePath()).fileName();
+    if (name.isEmpty() || !followDeviceMapper) {
+        return name;
+    }
+
+    // Follow device mapper (e.g. LUKS) nodes down to the backing partition.
+    for (int depth = 0; depth < 4; ++depth) {
+        const QStringList slaves = QDir(SysClassBlock + name + QStringLiteral("/slaves"))
+                .entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+        if (slaves.count() != 1) {
+            break;
+        }
+        name = slaves.first();
+    }
+
+    return name;
+}
+
+QString SysfsBlock::diskName(const QString &kernelName)
+{
+    if (!QFile::exists(SysClassBlock + kernelName + QStringLiteral("/partition"))) {
+        return kernelName;
+    }
+
+    // /sys/class/block/<partition> links into the directory of its disk.
+    const QFileInfo partition(QFileInfo(SysClassBlock + kernelName).canonicalFilePath());
+    return QFileInfo(partition.absolutePath()).fileName();
+}
+
+QByteArray SysfsBlock::readAttribute(const QString &kernelName, const QString &attribute)
+{
+    QFile file(SysClassBlock + kernelName + QLatin1Char('/') + attribute);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    return file.readAll().trimmed();
+}
+
+quint64 SysfsBlock::readNumber(const QString &kernelName, const QString &attribute, quint64 defaultValue)
+{
+    bool ok = false;
+    const quint64 value = readAttribute(kernelName, attribute).toULongLong(&ok);
+    return ok ? value : defaultValue;
+}
+
+bool SysfsBlock::writeAttribute(const QString &kernelName, const QString &attribute, const QByteArray &value)
+{
+    QFile file(SysClassBlock + kernelName + QLatin1Char('/') + attribute);
+    if (!file.open(QIODevice::WriteOnly) || file.write(value) != value.size()) {
+        qCWarning(lcMemoryCardLog) << "Cannot write" << value << "to" << file.fileName() << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+SysfsBlock::Geometry SysfsBlock::geometry(const QString &devicePath)
+{
+    Geometry geometry;
+
+    const QString name = kernelName(devicePath);
+    if (name.isEmpty()) {
+        return geometry;
+    }
+    const QString disk = diskName(name);
+
+    // Sizes and offsets in sysfs are always in 512 byte sectors.
+    geometry.size = readNumber(name, QStringLiteral("size")) * 512;
+    if (disk != name) {
+        geometry.startOffset = readNumber(name, QStringLiteral("start")) * 512;
+    }
+
+    geometry.logicalBlockSize = readNumber(disk, QStringLiteral("queue/logical_block_size"), 512);
+    geometry.physicalBlockSize = readNumber(disk, QStringLiteral("queue/physical_block_size"), 512);
+    geometry.minimumIoSize = readNumber(disk, QStringLiteral("queue/minimum_io_size"));
+    geometry.optimalIoSize = readNumber(disk, QStringLiteral("queue/optimal_io_size"));
+    geometry.discardGranularity = readNumber(disk, QStringLiteral("queue/discard_granularity"));
+    // Reported by the MMC core for eMMC and SD, the latter being the allocation unit size.
+    geometry.preferredEraseSize = readNumber(disk, QStringLiteral("device/preferred_erase_size"));
+
+    return geometry;
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2026 Nemo Mobile Project
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#ifndef SYSFSBLOCK_P_H
+#define SYSFSBLOCK_P_H
+
+#include <QString>
+
+// Helpers for reading the block layer attributes of /sys/class/block.
+namespace SysfsBlock {
+
+struct Geometry
+{
+    quint64 logicalBlockSize = 512;
+    quint64 physicalBlockSize = 512;
+    quint64 minimumIoSize = 0;
+    quint64 optimalIoSize = 0;
+    quint64 discardGranularity = 0;
+    quint64 preferredEraseSize = 0;
+    // Offset of the partition from the start of the disk, 0 for whole disks.
+    quint64 startOffset = 0;
+    quint64 size = 0;
+
+    bool isValid() const { return size > 0; }
+    bool supportsDiscard() const { return discardGranularity > 0; }
+    // False when the device reports nothing that hints at its erase block.
+    bool hasEraseBlockSize() const { return preferredEraseSize > 0 || discardGranularity > 0 || optimalIoSize > 0; }
+    // Best guess of the erase block (SD allocation unit), falls back to 4 MiB
+    // which is the most common allocation unit of SD cards.
+    quint64 eraseBlockSize() const;
+};
+
+// Resolves /dev/<name> or a device mapper node to the kernel name of the
+// underlying block device, e.g. /dev/mapper/luks-xxx to mmcblk1p1.
+// Without followDeviceMapper the name of the node itself is returned, e.g. dm-0.
+QString kernelName(const QString &devicePath, bool followDeviceMapper = true);
+
+// Kernel name of the whole disk a partition belongs to, the name itself for disks.
+QString diskName(const QString &kernelName);
+
+QByteArray readAttribute(const QString &kernelName, const QString &attribute);
+quint64 readNumber(const QString &kernelName, const QString &attribute, quint64 defaultValue = 0);
+bool writeAttribute(const QString &kernelName, const QString &attribute, const QByteArray &value);
+
+Geometry geometry(const QString &devicePath);
+
+}
+
+#endif
@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2026 Nemo Mobile Project
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include "trimscheduler_p.h"
+#include "logging_p.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QUrl>
+
+#include <mce/dbus-names.h>
+#include <mce/mode-names.h>
+
+namespace {
+
+// Matches the weekly interval of util-linux fstrim.timer.
+const qint64 TrimIntervalSeconds = 7 * 24 * 60 * 60;
+const int IdleCheckInterval = 10 * 60 * 1000;
+
+QString settingsPath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+            + QStringLiteral("/nemo-systemsettings/trim.ini");
+}
+
+QString settingsKey(const QString &key)
+{
+    // Device and mount paths contain slashes which QSettings treats as group separators.
+    return QStringLiteral("lastTrim/") + QString::fromLatin1(QUrl::toPercentEncoding(key));
+}
+
+}
+
+TrimScheduler::TrimScheduler(QObject *parent)
+    : QObject(parent)
+    , m_connection(QDBusConnection::systemBus())
+    , m_mceInterface(this, m_connection, MCE_SERVICE, MCE_REQUEST_PATH, MCE_REQUEST_IF)
+    , m_settings(settingsPath(), QSettings::IniFormat)
+    , m_charging(false)
+    , m_displayOff(false)
+{
+    m_idleTimer.setInterval(IdleCheckInterval);
+    connect(&m_idleTimer, &QTimer::timeout, this, &TrimScheduler::trimRequested);
+
+    m_connection.connectToSignal(
+            MCE_SERVICE, MCE_SIGNAL_PATH,
+            MCE_SIGNAL_IF, MCE_CHARGER_STATE_SIG,
+            this, SLOT(chargerStateChanged(QString)));
+    m_connection.connectToSignal(
+            MCE_SERVICE, MCE_SIGNAL_PATH,
+            MCE_SIGNAL_IF, MCE_DISPLAY_SIG,
+            this, SLOT(displayStatusChanged(QString)));
+
+    NemoDBus::Response *chargerState = m_mceInterface.call(MCE_CHARGER_STATE_GET);
+    chargerState->onFinished<QString>([this](const QString &value) {
+        chargerStateChanged(value);
+    });
+
+    NemoDBus::Response *displayStatus = m_mceInterface.call(MCE_DISPLAY_STATUS_GET);
+    displayStatus->onFinished<QString>([this](const QString &value) {
+        displayStatusChanged(value);
+    });
+}
+
+TrimScheduler::~TrimScheduler()
+{
+}
+
+bool TrimScheduler::isDue(const QString &key) const
+{
+    if (m_unsupported.contains(key)) {
+        return false;
+    }
+
+    const QDateTime lastTrim = m_settings.value(settingsKey(key)).toDateTime();
+    return !lastTrim.isValid() || lastTrim.secsTo(QDateTime::currentDateTimeUtc()) >= TrimIntervalSeconds;
+}
+
+void TrimScheduler::setTrimmed(const QString &key)
+{
+    QDir().mkpath(QFileInfo(m_settings.fileName()).absolutePath());
+    m_settings.setValue(settingsKey(key), QDateTime::currentDateTimeUtc());
+}
+
+void TrimScheduler::setUnsupported(const QString &key)
+{
+    m_unsupported.insert(key);
+}
+
+void TrimScheduler::chargerStateChanged(const QString &state)
+{
+    m_charging = state == QLatin1String(MCE_CHARGER_STATE_ON);
+    updateIdleTimer();
+}
+
+void TrimScheduler::displayStatusChanged(const QString &status)
+{
+    m_displayOff = status == QLatin1String(MCE_DISPLAY_OFF_STRING);
+    updateIdleTimer();
+}
+
+void TrimScheduler::updateIdleTimer()
+{
+    const bool idle = m_charging && m_displayOff;
+
+    if (idle && !m_idleTimer.isActive()) {
+        qCInfo(lcMemoryCardLog) << "Device idle, trimming in" << IdleCheckInterval / 1000 << "seconds";
+        m_idleTimer.start();
+    } else if (!idle) {
+        m_idleTimer.stop();
+    }
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2026 Nemo Mobile Project
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#ifndef TRIMSCHEDULER_P_H
+#define TRIMSCHEDULER_P_H
+
+#include <QObject>
+#include <QSet>
+#include <QSettings>
+#include <QTimer>
+
+#include <nemo-dbus/connection.h>
+#include <nemo-dbus/interface.h>
+
+// Requests periodic trimming of mounted file systems while the device
+// is charging and the display is off.
+class TrimScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    explicit TrimScheduler(QObject *parent = nullptr);
+    ~TrimScheduler();
+
+    bool isDue(const QString &key) const;
+    void setTrimmed(const QString &key);
+    // Stops requesting trims for the key until restart, for file systems or users trim fails for.
+    void setUnsupported(const QString &key);
+
+signals:
+    void trimRequested();
+
+private slots:
+    void chargerStateChanged(const QString &state);
+    void displayStatusChanged(const QString &status);
+
+private:
+    void updateIdleTimer();
+
+    NemoDBus::Connection m_connection;
+    NemoDBus::Interface m_mceInterface;
+    QSettings m_settings;
+    QTimer m_idleTimer;
+    QSet<QString> m_unsupported;
+    bool m_charging;
+    bool m_displayOff;
+};
+
+#endif
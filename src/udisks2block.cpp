@@ -1,5 +1,6 @@
 #include "udisks2block_p.h"
 #include "udisks2defines.h"
+#include "storagemetrics_p.h"
 #include "logging_p.h"
 
 #include <nemo-dbus/dbus.h>
@@ -40,6 +41,7 @@ public:
     bool m_pendingPartitionTable = false;
 };
 
+#include <QElapsedTimer>
 #include <QSequentialIterable>
 
 UDisks2::Block::Block(const QString &path, const UDisks2::InterfacePropertyMap &interfacePropertyMap, QObject *parent)
@@ -171,6 +173,11 @@ QString UDisks2::Block::driveVendor() const
     return NemoDBus::demarshallDBusArgument(d_ptr->m_drive.value(QStringLiteral("Vendor"))).toString();
 }
 
+bool UDisks2::Block::canPowerOff() const
+{
+    return NemoDBus::demarshallDBusArgument(d_ptr->m_drive.value(QStringLiteral("CanPowerOff"))).toBool();
+}
+
 QString UDisks2::Block::connectionBus() const
 {
     QString bus = NemoDBus::demarshallDBusArgument(d_ptr->m_drive.value(QStringLiteral("ConnectionBus"))).toString();
@@ -566,6 +573,9 @@ void UDisks2::Block::getProperties(const QString &path, const QString &interface
 
     *pending = true;
 
+    QElapsedTimer timer;
+    timer.start();
+
     NemoDBus::Interface dbusPropertyInterface(this, d_ptr->m_connection,
                                               UDISKS2_SERVICE, path, DBUS_OBJECT_PROPERTIES_INTERFACE);
     NemoDBus::Response *response = dbusPropertyInterface.call(DBUS_GET_ALL, interface);
@@ -577,7 +587,8 @@ void UDisks2::Block::getProperties(const QString &path, const QString &interface
         qCDebug(lcMemoryCardLog) << "Error reading" << interface << "properties:" << error.name() << error.message();
         failed();
     });
-    connect(response, &QObject::destroyed, this, [this, pending] {
+    connect(response, &QObject::destroyed, this, [this, pending, timer] {
+        StorageMetrics::time(QStringLiteral("dbus.") + DBUS_GET_ALL, timer.elapsed());
         *pending = false;
         complete();
     });
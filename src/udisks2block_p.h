@@ -64,6 +64,7 @@ public:
     QString drive() const;
     QString driveModel() const;
     QString driveVendor() const;
+    bool canPowerOff() const;
     QString connectionBus() const;
 
     QString partitionTable() const;
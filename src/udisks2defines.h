@@ -83,11 +83,13 @@ Q_DECLARE_METATYPE(UDisks2::InterfacePropertyMap)
 #define UDISKS2_FILESYSTEM_MOUNT   QLatin1String("Mount")
 #define UDISKS2_FILESYSTEM_UNMOUNT QLatin1String("Unmount")
 #define UDISKS2_BLOCK_RESCAN       QLatin1String("Rescan")
+#define UDISKS2_DRIVE_POWER_OFF    QLatin1String("PowerOff")
 
 // Errors
 #define UDISKS2_ERROR_DEVICE_BUSY        QLatin1String("org.freedesktop.UDisks2.Error.DeviceBusy")
 #define UDISKS2_ERROR_TARGET_BUSY        QLatin1String("target is busy")
 #define UDISKS2_ERROR_ALREADY_MOUNTED    "org.freedesktop.UDisks2.Error.AlreadyMounted"
 #define UDISKS2_ERROR_ALREADY_UNMOUNTING "org.freedesktop.UDisks2.Error.AlreadyUnmounting"
+#define UDISKS2_ERROR_OPTION_NOT_PERMITTED "org.freedesktop.UDisks2.Error.OptionNotPermitted"
 
 #endif
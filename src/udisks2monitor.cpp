@@ -37,6 +37,9 @@
 #include "nemo-dbus/dbus.h"
 
 #include "partitionmanager_p.h"
+#include "storagemetrics_p.h"
+#include "sysfsblock_p.h"
+#include "ueventmonitor_p.h"
 #include "logging_p.h"
 
 #include <QDBusConnection>
@@ -44,6 +47,8 @@
 #include <QDBusError>
 #include <QDBusInterface>
 #include <QDBusMetaType>
+#include <QElapsedTimer>
+#include <QTimer>
 
 struct ErrorEntry {
     Partition::Error errorCode;
@@ -70,6 +75,12 @@ static const ErrorEntry dbus_error_entries[] =
     { Partition::ErrorDeviceBusy,             "org.freedesktop.UDisks2.Error.DeviceBusy" }
 };
 
+// How long a partition reported by the kernel waits for udisks2 before it is dropped.
+static const int ProvisionalPartitionTimeout = 30000;
+
+// Block devices that are never external storage.
+static const QRegularExpression internalBlockDevice(QStringLiteral("^(loop|ram|zram|dm-|nbd|mmcblk\\d+(boot|rpmb))"));
+
 UDisks2::Monitor *UDisks2::Monitor::sharedInstance = nullptr;
 
 UDisks2::Monitor *UDisks2::Monitor::instance()
@@ -83,6 +94,7 @@ UDisks2::Monitor::Monitor(PartitionManagerPrivate *manager, QObject *parent)
     : QObject(parent)
     , m_manager(manager)
     , m_blockDevices(BlockDevices::instance())
+    , m_ueventMonitor(new UeventMonitor(this))
 {
     Q_ASSERT(!sharedInstance);
     sharedInstance = this;
@@ -136,6 +148,9 @@ UDisks2::Monitor::Monitor(PartitionManagerPrivate *manager, QObject *parent)
     getBlockDevices();
 
     connect(m_blockDevices, &BlockDevices::newBlock, this, &Monitor::handleNewBlock);
+
+    connect(m_ueventMonitor, &UeventMonitor::blockAdded, this, &Monitor::ueventBlockAdded);
+    connect(m_ueventMonitor, &UeventMonitor::blockRemoved, this, &Monitor::ueventBlockRemoved);
 }
 
 UDisks2::Monitor::~Monitor()
@@ -181,7 +196,48 @@ void UDisks2::Monitor::unlock(const QString &devicePath, const QString &passphra
     startLuksOperation(devicePath, UDISKS2_ENCRYPTED_UNLOCK, m_blockDevices->objectPath(devicePath), arguments);
 }
 
-void UDisks2::Monitor::mount(const QString &devicePath)
+// Options outside the udisks2 allow list (see udisks2 mount_options.conf) fail with
+// OptionNotPermitted. Older udisks2 releases allow fewer options, lazytime for one,
+// in which case the mount is retried with only the baseline options below.
+static QStringList mountOptions(const QString &filesystemType, Partition::MountProfile profile)
+{
+    const bool fat = filesystemType == QLatin1String("vfat") || filesystemType == QLatin1String("exfat");
+    QStringList options;
+
+    switch (profile) {
+    case Partition::MountProfileFlash:
+        options << QStringLiteral("noatime") << QStringLiteral("lazytime");
+        break;
+    case Partition::MountProfileDurable:
+        options << QStringLiteral("relatime");
+        if (filesystemType == QLatin1String("vfat")) {
+            options << QStringLiteral("flush");
+        }
+        break;
+    case Partition::MountProfileNone:
+        return options;
+    }
+
+    if (fat) {
+        options << QStringLiteral("iocharset=utf8");
+    }
+
+    return options;
+}
+
+// Allowed by every udisks2 release.
+static bool isBaselineMountOption(const QString &option)
+{
+    static const QStringList baseline = {
+        QStringLiteral("noatime"),
+        QStringLiteral("relatime"),
+        QStringLiteral("flush"),
+        QStringLiteral("iocharset=utf8")
+    };
+    return baseline.contains(option);
+}
+
+void UDisks2::Monitor::mount(const QString &devicePath, Partition::MountProfile profile)
 {
     QVariantList arguments;
     QVariantMap options;
@@ -198,6 +254,10 @@ void UDisks2::Monitor::mount(const QString &devicePath)
         Q_ASSERT(!objectPath.isEmpty());
 
         options.insert(QStringLiteral("fstype"), block->idType());
+        const QStringList profileOptions = mountOptions(block->idType(), profile);
+        if (!profileOptions.isEmpty()) {
+            options.insert(QStringLiteral("options"), profileOptions.join(QLatin1Char(',')));
+        }
         arguments << options;
         startMountOperation(devicePath, UDISKS2_FILESYSTEM_MOUNT, objectPath, arguments);
     } else {
@@ -252,6 +312,55 @@ void UDisks2::Monitor::format(const QString &devicePath, const QString &filesyst
     doFormat(devicePath, objectPath, filesystemType, arguments);
 }
 
+bool UDisks2::Monitor::canPowerOff(const QString &devicePath) const
+{
+    const Block *block = m_blockDevices->find(devicePath);
+    return block && block->canPowerOff();
+}
+
+void UDisks2::Monitor::powerOff(const QString &devicePath)
+{
+    const Block *block = m_blockDevices->find(devicePath);
+    if (!block || !block->canPowerOff()) {
+        qCWarning(lcMemoryCardLog) << "Cannot power off drive of" << devicePath;
+        emit powerOffError(devicePath, Partition::ErrorNotSupported);
+        return;
+    }
+
+    QDBusInterface driveInterface(UDISKS2_SERVICE,
+                                  block->drive(),
+                                  UDISKS2_DRIVE_INTERFACE,
+                                  QDBusConnection::systemBus());
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QDBusPendingCall pendingCall = driveInterface.asyncCall(UDISKS2_DRIVE_POWER_OFF, QVariantMap());
+    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(pendingCall, this);
+    connect(watcher, &QDBusPendingCallWatcher::finished,
+            this, [this, devicePath, timer](QDBusPendingCallWatcher *watcher) {
+        StorageMetrics::time(QStringLiteral("dbus.") + UDISKS2_DRIVE_POWER_OFF, timer.elapsed());
+
+        if (watcher->isError()) {
+            const QByteArray errorName = watcher->error().name().toLocal8Bit();
+            qCWarning(lcMemoryCardLog) << "udisks2 error:" << UDISKS2_DRIVE_POWER_OFF << "error:" << errorName;
+
+            Partition::Error error = Partition::ErrorFailed;
+            for (uint i = 0; i < sizeof(dbus_error_entries) / sizeof(ErrorEntry); i++) {
+                if (strcmp(dbus_error_entries[i].dbusErrorName, errorName.constData()) == 0) {
+                    error = dbus_error_entries[i].errorCode;
+                    break;
+                }
+            }
+            emit powerOffError(devicePath, error);
+        } else {
+            emit poweredOff(devicePath);
+        }
+
+        watcher->deleteLater();
+    });
+}
+
 void UDisks2::Monitor::interfacesAdded(const QDBusObjectPath &objectPath, const UDisks2::InterfacePropertyMap &interfaces)
 {
     QString path = objectPath.path();
@@ -260,6 +369,10 @@ void UDisks2::Monitor::interfacesAdded(const QDBusObjectPath &objectPath, const
     // A device must have file system or partition so that it can added to the model.
     // Devices without partition table can have a filesystem interface.
     if (path.startsWith(QStringLiteral("/org/freedesktop/UDisks2/block_devices/"))) {
+        StorageMetrics::count(QStringLiteral("interfacesAdded"));
+        if (!m_interfacesAddedTimes.contains(path)) {
+            m_interfacesAddedTimes[path].start();
+        }
         m_blockDevices->createBlockDevice(path, interfaces);
     } else if (path.startsWith(QStringLiteral("/org/freedesktop/UDisks2/jobs"))) {
         QVariantMap dict = interfaces.value(UDISKS2_JOB_INTERFACE);
@@ -308,6 +421,10 @@ void UDisks2::Monitor::interfacesRemoved(const QDBusObjectPath &objectPath, cons
     qCDebug(lcMemoryCardLog) << "UDisks interface removed:" << path;
     qCInfo(lcMemoryCardLog) << "UDisks dump interface:" << interfaces;
 
+    if (interfaces.contains(UDISKS2_BLOCK_INTERFACE)) {
+        m_interfacesAddedTimes.remove(path);
+    }
+
     if (m_jobsToWait.contains(path)) {
         UDisks2::Job *job = m_jobsToWait.take(path);
         // Make sure job is completed. Not sure if we can assume it success really.
@@ -346,6 +463,7 @@ void UDisks2::Monitor::setPartitionProperties(QExplicitlySharedDataPointer<Parti
 
     partition->mountPath = blockDevice->mountPath();
     partition->deviceLabel = label;
+    partition->uuid = blockDevice->idUUID();
     partition->filesystemType = blockDevice->idType();
     partition->isSupportedFileSystemType = m_manager->supportedFileSystems().contains(partition->filesystemType);
     partition->readOnly = blockDevice->isReadOnly();
@@ -491,14 +609,21 @@ void UDisks2::Monitor::startLuksOperation(const QString &devicePath, const QStri
                                     UDISKS2_ENCRYPTED_INTERFACE,
                                     QDBusConnection::systemBus());
 
+    QElapsedTimer timer;
+    timer.start();
+
     QDBusPendingCall pendingCall = udisks2Interface.asyncCallWithArgumentList(dbusMethod, arguments);
     QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(pendingCall, this);
     connect(watcher, &QDBusPendingCallWatcher::finished,
-            this, [this, devicePath, dbusMethod](QDBusPendingCallWatcher *watcher) {
+            this, [this, devicePath, dbusMethod, timer](QDBusPendingCallWatcher *watcher) {
+        StorageMetrics::time(QStringLiteral("dbus.") + dbusMethod, timer.elapsed());
+
         if (watcher->isValid() && watcher->isFinished()) {
             if (dbusMethod == UDISKS2_ENCRYPTED_LOCK) {
                 emit status(devicePath, Partition::Locked);
             } else {
+                qCInfo(lcMemoryCardLog) << "Unlocked" << devicePath << "in" << timer.elapsed() << "ms";
+                emit unlocked(devicePath, timer.elapsed());
                 emit status(devicePath, Partition::Unmounted);
             }
         } else if (watcher->isError()) {
@@ -511,7 +636,7 @@ void UDisks2::Monitor::startLuksOperation(const QString &devicePath, const QStri
             for (uint i = 0; i < sizeof(dbus_error_entries) / sizeof(ErrorEntry); i++) {
                 if (strcmp(dbus_error_entries[i].dbusErrorName, errorCStr) == 0) {
                     if (dbusMethod == UDISKS2_ENCRYPTED_LOCK) {
-                        emit lockError(dbus_error_entries[i].errorCode);
+                        emit lockError(devicePath, dbus_error_entries[i].errorCode);
                         break;
                     } else {
                         emit unlockError(dbus_error_entries[i].errorCode);
@@ -554,11 +679,40 @@ void UDisks2::Monitor::startMountOperation(const QString &devicePath, const QStr
                                     UDISKS2_FILESYSTEM_INTERFACE,
                                     QDBusConnection::systemBus());
 
+    QElapsedTimer timer;
+    timer.start();
+
     QDBusPendingCall pendingCall = udisks2Interface.asyncCallWithArgumentList(dbusMethod, arguments);
     QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(pendingCall, this);
     connect(watcher, &QDBusPendingCallWatcher::finished,
-            this, [this, devicePath, dbusMethod](QDBusPendingCallWatcher *watcher) {
-        if (watcher->isValid() && watcher->isFinished()) {
+            this, [this, devicePath, dbusMethod, dbusObjectPath, arguments, timer](QDBusPendingCallWatcher *watcher) {
+        StorageMetrics::time(QStringLiteral("dbus.") + dbusMethod, timer.elapsed());
+
+        QVariantMap options = arguments.value(0).toMap();
+        QStringList requestedOptions;
+        if (options.contains(QStringLiteral("options"))) {
+            requestedOptions = options.value(QStringLiteral("options")).toString().split(QLatin1Char(','));
+        }
+        QStringList baselineOptions;
+        for (const QString &option : requestedOptions) {
+            if (isBaselineMountOption(option)) {
+                baselineOptions.append(option);
+            }
+        }
+
+        if (watcher->isError()
+                && dbusMethod == UDISKS2_FILESYSTEM_MOUNT
+                && watcher->error().name() == QLatin1String(UDISKS2_ERROR_OPTION_NOT_PERMITTED)
+                && baselineOptions.count() < requestedOptions.count()) {
+            qCWarning(lcMemoryCardLog) << "Mount options" << requestedOptions
+                                       << "not permitted for" << devicePath << "- retrying with" << baselineOptions;
+            if (baselineOptions.isEmpty()) {
+                options.remove(QStringLiteral("options"));
+            } else {
+                options.insert(QStringLiteral("options"), baselineOptions.join(QLatin1Char(',')));
+            }
+            startMountOperation(devicePath, dbusMethod, dbusObjectPath, QVariantList() << options);
+        } else if (watcher->isValid() && watcher->isFinished()) {
             Block *block = m_blockDevices->find(devicePath);
             if (block && block->isFormatting()) {
                 // Do nothing
@@ -580,7 +734,7 @@ void UDisks2::Monitor::startMountOperation(const QString &devicePath, const QStr
                         emit mountError(dbus_error_entries[i].errorCode);
                         break;
                     } else {
-                        emit unmountError(dbus_error_entries[i].errorCode);
+                        emit unmountError(devicePath, dbus_error_entries[i].errorCode);
                         break;
                     }
                 }
@@ -630,6 +784,23 @@ PartitionManagerPrivate::PartitionList UDisks2::Monitor::lookupPartitions(const
 
 void UDisks2::Monitor::createPartition(const UDisks2::Block *block)
 {
+    if (m_interfacesAddedTimes.contains(block->path())) {
+        StorageMetrics::time(QStringLiteral("udisks.insertion"), m_interfacesAddedTimes.take(block->path()).elapsed());
+    }
+
+    // Complete the partition created from the kernel uevent, its connection bus was a guess.
+    for (auto partition : m_manager->m_partitions) {
+        if (partition->provisional && partition->devicePath == block->device()) {
+            partition->provisional = false;
+            partition->activeState.clear();
+            partition->bytesTotal = block->size();
+            setPartitionProperties(partition, block);
+            partition->valid = true;
+            m_manager->complete(partition);
+            return;
+        }
+    }
+
     QExplicitlySharedDataPointer<PartitionPrivate> partition(new PartitionPrivate(m_manager.data()));
     partition->storageType = Partition::External;
     partition->devicePath = block->device();
@@ -647,10 +818,15 @@ void UDisks2::Monitor::doFormat(const QString &devicePath, const QString &dbusOb
                                     UDISKS2_BLOCK_INTERFACE,
                                     QDBusConnection::systemBus());
 
+    QElapsedTimer timer;
+    timer.start();
+
     QDBusPendingCall pendingCall = blockDeviceInterface.asyncCall(UDISKS2_BLOCK_FORMAT, filesystemType, arguments);
     QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(pendingCall, this);
     connect(watcher, &QDBusPendingCallWatcher::finished,
-            this, [this, devicePath, dbusObjectPath, arguments](QDBusPendingCallWatcher *watcher) {
+            this, [this, devicePath, dbusObjectPath, arguments, timer](QDBusPendingCallWatcher *watcher) {
+        StorageMetrics::time(QStringLiteral("dbus.") + UDISKS2_BLOCK_FORMAT, timer.elapsed());
+
         if (watcher->isValid() && watcher->isFinished()) {
             emit status(devicePath, Partition::Formatted);
         } else if (watcher->isError()) {
@@ -680,11 +856,21 @@ void UDisks2::Monitor::getBlockDevices()
                                     UDISKS2_MANAGER_PATH,
                                     UDISKS2_MANAGER_INTERFACE,
                                     QDBusConnection::systemBus());
+    QElapsedTimer timer;
+    timer.start();
+
+    // Startup enumeration, from the request to every block device being probed.
+    connect(m_blockDevices, &BlockDevices::externalStoragesPopulated, this, [timer]() {
+        StorageMetrics::time(QStringLiteral("udisks.populate"), timer.elapsed());
+    });
+
     QDBusPendingCall pendingCall = managerInterface.asyncCallWithArgumentList(
                 QStringLiteral("GetBlockDevices"),
                 QVariantList() << QVariantMap());
     QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(pendingCall, this);
-    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this](QDBusPendingCallWatcher *watcher) {
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this, timer](QDBusPendingCallWatcher *watcher) {
+        StorageMetrics::time(QStringLiteral("dbus.GetBlockDevices"), timer.elapsed());
+
         if (watcher->isValid() && watcher->isFinished()) {
             QDBusPendingReply<QList<QDBusObjectPath> > reply = *watcher;
             const QList<QDBusObjectPath> blockDevicePaths = reply.argumentAt<0>();
@@ -692,6 +878,8 @@ void UDisks2::Monitor::getBlockDevices()
         } else if (watcher->isError()) {
             QDBusError error = watcher->error();
             qCWarning(lcMemoryCardLog) << "Unable to enumerate block devices:" << error.name() << error.message();
+            // Nothing to wait for, devices added later still arrive through InterfacesAdded.
+            m_blockDevices->createBlockDevices(QList<QDBusObjectPath>());
         }
     });
 }
@@ -790,6 +978,77 @@ void UDisks2::Monitor::handleNewBlock(UDisks2::Block *block, bool forceCreatePar
     connectSignals(block);
 }
 
+void UDisks2::Monitor::ueventBlockAdded(const QString &kernelName, const QString &sysfsPath, bool isPartition)
+{
+    // Whole disks may still get a partition table, leave them to udisks2.
+    if (!isPartition || internalBlockDevice.match(kernelName).hasMatch() || !m_blockDevices->populated()) {
+        return;
+    }
+
+    const QString devicePath = QStringLiteral("/dev/") + kernelName;
+    for (const auto &partition : m_manager->m_partitions) {
+        if (partition->devicePath == devicePath) {
+            return;
+        }
+    }
+
+    // Best effort drive details, replaced by the udisks2 ones once the block device is published.
+    const QString disk = SysfsBlock::diskName(kernelName);
+    QVariantMap drive;
+    if (kernelName.startsWith(QLatin1String("mmcblk"))) {
+        drive.insert(QLatin1String("connectionBus"), Partition::SDIO);
+        drive.insert(QLatin1String("model"), QString::fromUtf8(SysfsBlock::readAttribute(disk, QStringLiteral("device/name"))));
+        drive.insert(QLatin1String("vendor"), QString());
+    } else {
+        drive.insert(QLatin1String("connectionBus"), sysfsPath.contains(QLatin1String("/usb"))
+                     ? Partition::USB : Partition::UnknownBus);
+        drive.insert(QLatin1String("model"), QString::fromUtf8(SysfsBlock::readAttribute(disk, QStringLiteral("device/model"))));
+        drive.insert(QLatin1String("vendor"), QString::fromUtf8(SysfsBlock::readAttribute(disk, QStringLiteral("device/vendor"))));
+    }
+
+    QExplicitlySharedDataPointer<PartitionPrivate> partition(new PartitionPrivate(m_manager.data()));
+    partition->storageType = Partition::External;
+    partition->devicePath = devicePath;
+    partition->deviceName = kernelName;
+    partition->deviceRoot = deviceRoot.match(kernelName).hasMatch();
+    partition->bytesTotal = qint64(SysfsBlock::readNumber(kernelName, QStringLiteral("size"))) * 512;
+    partition->drive = drive;
+    partition->status = Partition::Mounting;
+    // Keeps refresh from resetting the status while udisks2 probes the device.
+    partition->activeState = QStringLiteral("activating");
+    partition->provisional = true;
+
+    qCInfo(lcMemoryCardLog) << "Kernel reported" << devicePath << "before udisks2";
+    m_manager->add(partition);
+
+    QTimer::singleShot(ProvisionalPartitionTimeout, this, [this, partition]() {
+        if (partition->provisional && m_manager->m_partitions.contains(partition)) {
+            qCWarning(lcMemoryCardLog) << "udisks2 did not publish" << partition->devicePath << "dropping it";
+            m_manager->remove(PartitionManagerPrivate::PartitionList() << partition);
+        }
+    });
+}
+
+void UDisks2::Monitor::ueventBlockRemoved(const QString &kernelName)
+{
+    const QString devicePath = QStringLiteral("/dev/") + kernelName;
+
+    // The card is gone, don't wait for udisks2 to notice. Formatting re-reads the partition table.
+    PartitionManagerPrivate::PartitionList removedPartitions;
+    for (const auto &partition : m_manager->m_partitions) {
+        if (partition->storageType == Partition::External
+                && partition->status != Partition::Formatting
+                && (partition->devicePath == devicePath || partition->cryptoBackingDevicePath == devicePath)) {
+            removedPartitions << partition;
+        }
+    }
+
+    if (!removedPartitions.isEmpty()) {
+        qCInfo(lcMemoryCardLog) << "Kernel removed" << devicePath;
+        m_manager->remove(removedPartitions);
+    }
+}
+
 void UDisks2::Monitor::jobCompleted(bool success, const QString &msg)
 {
     QString jobPath = message().path();
@@ -35,7 +35,9 @@
 #include <QObject>
 #include <QDBusObjectPath>
 #include <QDBusContext>
+#include <QElapsedTimer>
 #include <QExplicitlySharedDataPointer>
+#include <QHash>
 #include <QRegularExpression>
 #include <QQueue>
 #include <QVariantList>
@@ -45,6 +47,7 @@
 #include "udisks2defines.h"
 
 class PartitionManagerPrivate;
+class UeventMonitor;
 
 static const QRegularExpression deviceRoot(QStringLiteral("^mmcblk\\d+$"));
 
@@ -84,19 +87,27 @@ public:
     void lock(const QString &devicePath);
     void unlock(const QString &devicePath, const QString &passphrase);
 
-    void mount(const QString &devicePath);
+    void mount(const QString &devicePath, Partition::MountProfile profile = Partition::MountProfileFlash);
     void unmount(const QString &devicePath);
 
     void format(const QString &devicePath, const QString &filesystemType, const QVariantMap &arguments);
 
+    bool canPowerOff(const QString &devicePath) const;
+    void powerOff(const QString &devicePath);
+
 signals:
     void status(const QString &devicePath, Partition::Status);
     void errorMessage(const QString &objectPath, const QString &errorName);
-    void lockError(Partition::Error error);
+    void lockError(const QString &devicePath, Partition::Error error);
     void unlockError(Partition::Error error);
+    // Time from requesting the unlock to udisks2 replying, mostly spent in the key derivation
+    // but including any polkit authentication prompt shown in between.
+    void unlocked(const QString &devicePath, qint64 duration);
     void mountError(Partition::Error error);
-    void unmountError(Partition::Error error);
+    void unmountError(const QString &devicePath, Partition::Error error);
     void formatError(Partition::Error error);
+    void poweredOff(const QString &devicePath);
+    void powerOffError(const QString &devicePath, Partition::Error error);
 
 private slots:
     void interfacesAdded(const QDBusObjectPath &objectPath, const UDisks2::InterfacePropertyMap &interfaces);
@@ -105,6 +116,8 @@ private slots:
                   const QVariantMap &arguments);
     void handleNewBlock(UDisks2::Block *block, bool forceCreatePartition);
     void jobCompleted(bool success, const QString &msg);
+    void ueventBlockAdded(const QString &kernelName, const QString &sysfsPath, bool isPartition);
+    void ueventBlockRemoved(const QString &kernelName);
 
 private:
     void setPartitionProperties(QExplicitlySharedDataPointer<PartitionPrivate> &partition, const Block *blockDevice);
@@ -131,6 +144,10 @@ private:
     QQueue<Operation> m_operationQueue;
 
     BlockDevices *m_blockDevices;
+    UeventMonitor *m_ueventMonitor;
+
+    // InterfacesAdded of block devices not yet turned into partitions.
+    QHash<QString, QElapsedTimer> m_interfacesAddedTimes;
 };
 
 }
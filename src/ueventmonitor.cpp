@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2026 Nemo Mobile Project
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include "ueventmonitor_p.h"
+#include "logging_p.h"
+
+#include <QSocketNotifier>
+
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <linux/netlink.h>
+
+namespace {
+
+// Kernel uevent multicast group, the udev group carries the same events only after udev has processed them.
+const unsigned int KernelUeventGroup = 1;
+
+}
+
+UeventMonitor::UeventMonitor(QObject *parent)
+    : QObject(parent)
+    , m_socket(::socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_KOBJECT_UEVENT))
+    , m_notifier(nullptr)
+{
+    if (m_socket < 0) {
+        qCWarning(lcMemoryCardLog) << "Cannot open uevent socket:" << strerror(errno);
+        return;
+    }
+
+    struct sockaddr_nl address;
+    memset(&address, 0, sizeof(address));
+    address.nl_family = AF_NETLINK;
+    address.nl_groups = KernelUeventGroup;
+
+    if (::bind(m_socket, reinterpret_cast<struct sockaddr *>(&address), sizeof(address)) != 0) {
+        qCWarning(lcMemoryCardLog) << "Cannot bind uevent socket:" << strerror(errno);
+        ::close(m_socket);
+        m_socket = -1;
+        return;
+    }
+
+    m_notifier = new QSocketNotifier(m_socket, QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, &UeventMonitor::readEvents);
+}
+
+UeventMonitor::~UeventMonitor()
+{
+    delete m_notifier;
+    if (m_socket >= 0) {
+        ::close(m_socket);
+    }
+}
+
+bool UeventMonitor::isValid() const
+{
+    return m_socket >= 0;
+}
+
+void UeventMonitor::readEvents()
+{
+    char buffer[8192];
+
+    for (;;) {
+        struct sockaddr_nl sender;
+        socklen_t senderLength = sizeof(sender);
+        const ssize_t length = ::recvfrom(m_socket, buffer, sizeof(buffer), 0,
+                                          reinterpret_cast<struct sockaddr *>(&sender), &senderLength);
+        if (length < 0) {
+            if (errno == EINTR) {
+                continue;
+            } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                qCWarning(lcMemoryCardLog) << "Cannot read uevent socket:" << strerror(errno);
+            }
+            return;
+        }
+
+        // Only trust the kernel, any process could send to the group.
+        if (sender.nl_pid != 0) {
+            continue;
+        }
+
+        // "action@devpath" header followed by NUL separated KEY=value pairs.
+        QByteArray action;
+        QByteArray subsystem;
+        QByteArray devicePath;
+        QByteArray deviceName;
+        QByteArray deviceType;
+        const QList<QByteArray> fields = QByteArray::fromRawData(buffer, int(length)).split('\0');
+        for (const QByteArray &field : fields) {
+            const int separator = field.indexOf('=');
+            if (separator <= 0) {
+                continue;
+            }
+
+            const QByteArray key = field.left(separator);
+            const QByteArray value = field.mid(separator + 1);
+            if (key == "ACTION") {
+                action = value;
+            } else if (key == "SUBSYSTEM") {
+                subsystem = value;
+            } else if (key == "DEVPATH") {
+                devicePath = value;
+            } else if (key == "DEVNAME") {
+                deviceName = value;
+            } else if (key == "DEVTYPE") {
+                deviceType = value;
+            }
+        }
+
+        if (subsystem != "block" || deviceName.isEmpty()) {
+            continue;
+        }
+
+        qCDebug(lcMemoryCardLog) << "Block uevent:" << action << deviceName << deviceType;
+
+        if (action == "add") {
+            emit blockAdded(QString::fromUtf8(deviceName), QString::fromUtf8(devicePath), deviceType == "partition");
+        } else if (action == "remove") {
+            emit blockRemoved(QString::fromUtf8(deviceName));
+        }
+    }
+}
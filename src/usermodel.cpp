@@ -30,6 +30,7 @@
  */
 
 #include "usermodel.h"
+#include "diskquota_p.h"
 #include "logging_p.h"
 
 #include <QDBusConnection>
@@ -99,6 +100,7 @@ public:
     void add(UserInfo &user);
     void createInterface();
     void destroyInterface();
+    bool updateDiskUsage(uint uid);
 
     UserModel *q;
     QVector<UserInfo> m_users;
@@ -107,6 +109,8 @@ public:
     NemoDBus::Interface *m_dBusInterface;
     QDBusServiceWatcher *m_dBusWatcher;
     bool m_guestEnabled;
+    QString m_homeDevicePath;
+    QHash<uint, DiskQuota::Usage> m_diskUsage;
 };
 
 UserModelPrivate::UserModelPrivate(UserModel *parent)
@@ -116,6 +120,7 @@ UserModelPrivate::UserModelPrivate(UserModel *parent)
     , m_dBusWatcher(new QDBusServiceWatcher(UserManagerService, QDBusConnection::systemBus(),
                     QDBusServiceWatcher::WatchForRegistration | QDBusServiceWatcher::WatchForUnregistration, this))
     , m_guestEnabled(getpwuid((uid_t)SAILFISH_USERMANAGER_GUEST_UID))
+    , m_homeDevicePath(DiskQuota::devicePath(QStringLiteral("/home")))
 {
     connect(m_dBusWatcher, &QDBusServiceWatcher::serviceRegistered,
             this, &UserModelPrivate::createInterface);
@@ -136,6 +141,7 @@ UserModelPrivate::UserModelPrivate(UserModel *parent)
             if (user.isValid()) { // Skip invalid users here
                 m_users.append(user);
                 m_uidsToRows.insert(user.uid(), m_users.count()-1);
+                updateDiskUsage(user.uid());
             }
         }
     }
@@ -180,6 +186,7 @@ void UserModelPrivate::onUserRemoved(uint uid)
     int row = m_uidsToRows.value(uid);
     q->beginRemoveRows(QModelIndex(), row, row);
     m_transitioning.remove(uid);
+    m_diskUsage.remove(uid);
     m_users.remove(row);
     // It is slightly costly to remove users since some row numbers may need to be updated
     m_uidsToRows.remove(uid);
@@ -222,8 +229,22 @@ void UserModelPrivate::onGuestUserEnabled(bool enabled)
     }
 }
 
+bool UserModelPrivate::updateDiskUsage(uint uid)
+{
+    DiskQuota::Usage usage;
+    if (!DiskQuota::usage(m_homeDevicePath, uid, &usage)) {
+        return m_diskUsage.remove(uid) > 0;
+    }
+
+    const DiskQuota::Usage previous = m_diskUsage.value(uid);
+    m_diskUsage.insert(uid, usage);
+    return previous.bytesUsed != usage.bytesUsed || previous.bytesLimit != usage.bytesLimit;
+}
+
 void UserModelPrivate::add(UserInfo &user)
 {
+    updateDiskUsage(user.uid());
+
     if (q->placeholder() && m_transitioning.contains(m_users.last().uid())
             && m_users.last().name() == user.name()) {
         // This is the placeholder we were adding, "change" that
@@ -380,6 +401,8 @@ QHash<int, QByteArray> UserModel::roleNames() const
         { CurrentRole, "current" },
         { PlaceholderRole, "placeholder" },
         { TransitioningRole, "transitioning" },
+        { DiskUsageRole, "diskUsage" },
+        { DiskQuotaRole, "diskQuota" },
     };
     return roles;
 }
@@ -413,6 +436,10 @@ QVariant UserModel::data(const QModelIndex &index, int role) const
         return !user.isValid();
     case TransitioningRole:
         return d_ptr->m_transitioning.contains(user.uid());
+    case DiskUsageRole:
+        return d_ptr->m_diskUsage.value(user.uid()).bytesUsed;
+    case DiskQuotaRole:
+        return d_ptr->m_diskUsage.value(user.uid()).bytesLimit;
     default:
         return QVariant();
     }
@@ -456,6 +483,8 @@ bool UserModel::setData(const QModelIndex &index, const QVariant &value, int rol
     case CurrentRole:
     case PlaceholderRole:
     case TransitioningRole:
+    case DiskUsageRole:
+    case DiskQuotaRole:
     default:
         return false;
     }
@@ -619,6 +648,22 @@ void UserModel::removeGroups(int row, const QStringList &groups)
     });
 }
 
+/*
+ * Queries the quota usage of every user again
+ *
+ * Does nothing, not even a syscall per user, if quotas are not enabled for /home.
+ */
+void UserModel::refreshDiskUsage()
+{
+    for (int row = 0; row < d_ptr->m_users.count(); ++row) {
+        const UserInfo &user = d_ptr->m_users.at(row);
+        if (user.isValid() && d_ptr->updateDiskUsage(user.uid())) {
+            auto idx = index(row, 0);
+            emit dataChanged(idx, idx, QVector<int>() << DiskUsageRole << DiskQuotaRole);
+        }
+    }
+}
+
 bool UserModel::guestEnabled() const
 {
     return d_ptr->m_guestEnabled;
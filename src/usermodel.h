@@ -61,6 +61,11 @@ public:
         CurrentRole,
         PlaceholderRole,
         TransitioningRole,
+        // Bytes used and the quota soft limit on /home, -1 when unknown. The kernel
+        // reports the quota of other users only to processes with CAP_SYS_ADMIN, so
+        // without it both are -1 for every user but the current one.
+        DiskUsageRole,
+        DiskQuotaRole,
     };
     Q_ENUM(Roles)
 
@@ -116,6 +121,9 @@ public:
     Q_INVOKABLE void addGroups(int row, const QStringList &groups);
     Q_INVOKABLE void removeGroups(int row, const QStringList &groups);
 
+    // Space used on /home and the quota (0 for none) of each user, -1 where quotas are off
+    Q_INVOKABLE void refreshDiskUsage();
+
     // Guest methods
     bool guestEnabled() const;
     Q_INVOKABLE void setGuestEnabled(bool enabled);
@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2026 Nemo Mobile Project
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include "weartelemetry_p.h"
+#include "sysfsblock_p.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QUrl>
+
+#include <algorithm>
+
+namespace {
+
+const int LifeTimeExceeded = 0x0b;
+
+int parseHex(const QByteArray &value)
+{
+    bool ok = false;
+    const int result = value.trimmed().toInt(&ok, 16);
+    return ok ? result : -1;
+}
+
+QString settingsPath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation)
+            + QStringLiteral("/nemo-systemsettings/write-counters.ini");
+}
+
+}
+
+WearTelemetry::Wear WearTelemetry::read(const QString &devicePath)
+{
+    Wear wear;
+
+    const QString name = SysfsBlock::kernelName(devicePath, false);
+    if (name.isEmpty()) {
+        return wear;
+    }
+
+    const QList<QByteArray> stat = SysfsBlock::readAttribute(name, QStringLiteral("stat")).simplified().split(' ');
+    if (stat.count() > 6) {
+        // Field 7 is the number of sectors written, always in 512 byte units.
+        wear.bytesWrittenSinceBoot = stat.at(6).toLongLong() * 512;
+    }
+
+    QFile lifetimeWrites(QStringLiteral("/sys/fs/ext4/") + name + QStringLiteral("/lifetime_write_kbytes"));
+    if (lifetimeWrites.open(QIODevice::ReadOnly)) {
+        bool ok = false;
+        const qint64 kiloBytes = lifetimeWrites.readAll().trimmed().toLongLong(&ok);
+        if (ok) {
+            wear.filesystemBytesWritten = kiloBytes * 1024;
+        }
+    }
+
+    // Life time estimates are only provided by eMMC, "0x01 0x02" for type A and B memories.
+    const QString disk = SysfsBlock::diskName(SysfsBlock::kernelName(devicePath));
+    const QList<QByteArray> lifeTime = SysfsBlock::readAttribute(disk, QStringLiteral("device/life_time")).split(' ');
+    for (const QByteArray &estimate : lifeTime) {
+        const int value = parseHex(estimate);
+        if (value > 0 && value <= LifeTimeExceeded) {
+            wear.lifeTimeEstimate = std::max(wear.lifeTimeEstimate, value * 10);
+        }
+    }
+
+    wear.preEolInfo = std::max(0, parseHex(SysfsBlock::readAttribute(disk, QStringLiteral("device/pre_eol_info"))));
+
+    return wear;
+}
+
+WriteCounterStore::WriteCounterStore()
+    : m_settings(settingsPath(), QSettings::IniFormat)
+{
+    QFile bootId(QStringLiteral("/proc/sys/kernel/random/boot_id"));
+    if (bootId.open(QIODevice::ReadOnly)) {
+        m_bootId = QString::fromLatin1(bootId.readAll().trimmed());
+    }
+    QDir().mkpath(QFileInfo(settingsPath()).absolutePath());
+}
+
+qint64 WriteCounterStore::update(const QString &key, qint64 bytesWrittenSinceBoot)
+{
+    if (bytesWrittenSinceBoot < 0) {
+        return -1;
+    }
+
+    m_settings.beginGroup(QString::fromLatin1(QUrl::toPercentEncoding(key)));
+
+    qint64 previousBoots = m_settings.value(QStringLiteral("previousBoots"), 0).toLongLong();
+    const qint64 storedSinceBoot = m_settings.value(QStringLiteral("sinceBoot"), 0).toLongLong();
+
+    // A new boot, or the device reappeared with fresh counters during this one.
+    const bool countersReset = m_settings.value(QStringLiteral("bootId")).toString() != m_bootId
+            || bytesWrittenSinceBoot < storedSinceBoot;
+    if (countersReset) {
+        previousBoots += storedSinceBoot;
+        m_settings.setValue(QStringLiteral("bootId"), m_bootId);
+        m_settings.setValue(QStringLiteral("previousBoots"), previousBoots);
+    }
+
+    if (countersReset || storedSinceBoot != bytesWrittenSinceBoot) {
+        m_settings.setValue(QStringLiteral("sinceBoot"), bytesWrittenSinceBoot);
+    }
+
+    m_settings.endGroup();
+
+    return previousBoots + bytesWrittenSinceBoot;
+}
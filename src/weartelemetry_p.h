@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2026 Nemo Mobile Project
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#ifndef WEARTELEMETRY_P_H
+#define WEARTELEMETRY_P_H
+
+#include <QSettings>
+#include <QString>
+
+// Flash wear indicators of the device behind a partition.
+namespace WearTelemetry {
+
+struct Wear
+{
+    // Upper bound of the used life time in percent from the eMMC life_time estimates,
+    // 110 once exceeded and -1 when not reported.
+    int lifeTimeEstimate = -1;
+    // JEDEC pre-EOL value, see Partition::PreEolInfo.
+    int preEolInfo = 0;
+    // ext4 lifetime_write_kbytes in bytes, -1 for other file systems.
+    qint64 filesystemBytesWritten = -1;
+    // Written sectors of the block device since it appeared, i.e. usually since boot.
+    qint64 bytesWrittenSinceBoot = -1;
+};
+
+// Reads sysfs only, safe to call from any thread.
+Wear read(const QString &devicePath);
+
+}
+
+// Keeps a running total of bytes written to each partition across boots.
+// The per boot counters are folded into the total when the boot id changes.
+class WriteCounterStore
+{
+public:
+    WriteCounterStore();
+
+    qint64 update(const QString &key, qint64 bytesWrittenSinceBoot);
+
+private:
+    QSettings m_settings;
+    QString m_bootId;
+};
+
+#endif
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2026 Nemo Mobile Project
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+// Discards the unused blocks of a mounted file system. FITRIM needs CAP_SYS_ADMIN so this is
+// installed setuid and run by PartitionManagerPrivate. Prints the number of bytes discarded
+// and exits with the errno of the failure otherwise.
+
+#include <QByteArray>
+#include <QDebug>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits>
+#include <string.h>
+#include <mntent.h>
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#include <sailfishaccesscontrol.h>
+
+static bool isBlockDeviceMount(const QByteArray &mountPath)
+{
+    FILE *mounts = setmntent("/proc/self/mounts", "r");
+    if (!mounts) {
+        return false;
+    }
+
+    bool found = false;
+    while (struct mntent *entry = getmntent(mounts)) {
+        if (mountPath == entry->mnt_dir && strncmp(entry->mnt_fsname, "/dev/", 5) == 0) {
+            found = true;
+            break;
+        }
+    }
+    endmntent(mounts);
+
+    return found;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 2) {
+        qWarning() << "No mount path given";
+        return EINVAL;
+    }
+
+    if (!sailfish_access_control_hasgroup(getuid(), "users")) {
+        qWarning() << "User with id" << getuid() << "is not member of users group";
+        return EPERM;
+    }
+
+    // Only file systems of block devices, anything else is rejected before it is opened.
+    const QByteArray mountPath(argv[1]);
+    if (!isBlockDeviceMount(mountPath)) {
+        qWarning() << "Not a mounted block device:" << mountPath;
+        return EINVAL;
+    }
+
+    const int fd = ::open(mountPath.constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        const int error = errno;
+        qWarning() << "Unable to open" << mountPath << ":" << strerror(error);
+        return error;
+    }
+
+    struct fstrim_range range = {};
+    range.len = std::numeric_limits<decltype(range.len)>::max();
+
+    // On success the kernel updates range.len to the number of bytes discarded.
+    if (::ioctl(fd, FITRIM, &range) != 0) {
+        const int error = errno;
+        ::close(fd);
+        qWarning() << "Unable to trim" << mountPath << ":" << strerror(error);
+        return error;
+    }
+    ::close(fd);
+
+    printf("%llu\n", static_cast<unsigned long long>(range.len));
+
+    return EXIT_SUCCESS;
+}
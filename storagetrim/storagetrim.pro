@@ -0,0 +1,14 @@
+TEMPLATE = app
+TARGET = storagetrim
+TARGETPATH = /usr/libexec
+target.path = $$TARGETPATH
+
+QT = core
+
+CONFIG += link_pkgconfig
+PKGCONFIG += sailfishaccesscontrol
+
+SOURCES += \
+    main.cpp
+
+INSTALLS += target
@@ -4,6 +4,8 @@ src_plugins.subdir = src/plugin
 src_plugins.target = sub-plugins
 src_plugins.depends = src
 
+tests.depends = src
+
 OTHER_FILES += rpm/nemo-qml-plugin-systemsettings.spec
 
-SUBDIRS = src src_plugins setlocale translations
+SUBDIRS = src src_plugins setlocale storagetrim translations tests
@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2026 Nemo Mobile Project
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include <QtTest>
+#include <QEventLoop>
+#include <QFile>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+
+#include "certificatemodel.h"
+
+// The fixture holds 48 self-signed certificates, with UTF-8 names, RSA and EC keys,
+// and validity periods ending in both UTCTime and GeneralizedTime.
+static const int FixtureCount = 48;
+
+class BenchmarkCertificateModel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void fields();
+    void sorted();
+
+    void benchmarkParse();
+    void benchmarkModelBuild();
+
+private:
+    // Parses the whole bundle each time. The store drops the bundle along with the
+    // last model using it, and bundles outside the system trust store are not
+    // cached on disk, so no certificate is known to the store beforehand.
+    int buildModel(CertificateModel *model);
+
+    QTemporaryDir m_dir;
+    QString m_path;
+    QByteArray m_pem;
+};
+
+void BenchmarkCertificateModel::initTestCase()
+{
+    // Keeps the bundle cache out of the user's cache directory.
+    QStandardPaths::setTestModeEnabled(true);
+
+    QVERIFY(m_dir.isValid());
+
+    m_path = m_dir.filePath(QStringLiteral("bundle.pem"));
+    QVERIFY(QFile::copy(QStringLiteral(FIXTURE_DIR "/bundle.pem"), m_path));
+
+    QFile file(m_path);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    m_pem = file.readAll();
+}
+
+void BenchmarkCertificateModel::fields()
+{
+    const QList<Certificate> certificates = CertificateModel::getCertificates(m_pem);
+    QCOMPARE(certificates.count(), FixtureCount);
+
+    bool found = false;
+    for (const Certificate &certificate : certificates) {
+        if (certificate.commonName() == QLatin1String("Nemo Test Root Root 12")) {
+            found = true;
+            QCOMPARE(certificate.organizationName(), QStringLiteral("Nemo Test Root"));
+            QCOMPARE(certificate.organizationalUnitName(), QStringLiteral("Benchmark 1"));
+            QCOMPARE(certificate.countryName(), QStringLiteral("DK"));
+            // Valid for 20000 days, so the end is a GeneralizedTime.
+            QCOMPARE(certificate.notValidBefore().daysTo(certificate.notValidAfter()), qint64(20000));
+            QVERIFY(certificate.notValidAfter().date().year() > 2049);
+            QCOMPARE(certificate.details().value(QStringLiteral("SerialNumber")).toString(), QStringLiteral("1012"));
+        } else if (certificate.commonName() == QString::fromUtf8("\xc3\x85lborg Certifikat Root 14")) {
+            // Ends within the UTCTime range.
+            QCOMPARE(certificate.notValidBefore().daysTo(certificate.notValidAfter()), qint64(3650));
+        }
+    }
+    QVERIFY(found);
+}
+
+void BenchmarkCertificateModel::sorted()
+{
+    CertificateModel model;
+    QCOMPARE(buildModel(&model), FixtureCount);
+
+    QHash<QString, int> rows;
+    for (int row = 0; row < model.rowCount(); ++row) {
+        rows.insert(model.data(model.index(row), CertificateModel::PrimaryNameRole).toString(), row);
+    }
+
+    // Accents are folded for sorting, so Å sorts with A rather than after Z.
+    const int academie = rows.value(QString::fromUtf8("Acad\xc3\xa9mie Num\xc3\xa9rique Root 17"), -1);
+    const int alborg = rows.value(QString::fromUtf8("\xc3\x85lborg Certifikat Root 02"), -1);
+    const int delta = rows.value(QStringLiteral("Delta Verify Root 11"), -1);
+    QVERIFY(academie != -1);
+    QVERIFY(academie < alborg);
+    QVERIFY(alborg < delta);
+}
+
+void BenchmarkCertificateModel::benchmarkParse()
+{
+    QBENCHMARK {
+        QCOMPARE(CertificateModel::getCertificates(m_pem).count(), FixtureCount);
+    }
+}
+
+void BenchmarkCertificateModel::benchmarkModelBuild()
+{
+    QBENCHMARK {
+        CertificateModel model;
+        QCOMPARE(buildModel(&model), FixtureCount);
+    }
+}
+
+int BenchmarkCertificateModel::buildModel(CertificateModel *model)
+{
+    QEventLoop loop;
+    connect(model, &CertificateModel::loadingChanged, &loop, [model, &loop]() {
+        if (!model->loading()) {
+            loop.quit();
+        }
+    });
+
+    model->setBundlePath(m_path);
+    if (model->loading()) {
+        loop.exec();
+    }
+
+    return model->rowCount();
+}
+
+QTEST_GUILESS_MAIN(BenchmarkCertificateModel)
+
+#include "benchmark_certificatemodel.moc"
@@ -0,0 +1,21 @@
+TEMPLATE = app
+TARGET = benchmark_certificatemodel
+
+QT = core testlib
+CONFIG += testcase no_testcase_installs
+
+INCLUDEPATH += ../../src
+equals(QT_MAJOR_VERSION, 6) {
+LIBS += -L../../src -lsystemsettings-qt6
+} else {
+LIBS += -L../../src -lsystemsettings
+}
+QMAKE_RPATHDIR += $$OUT_PWD/../../src
+
+DEFINES += FIXTURE_DIR=\\\"$$PWD/data\\\"
+
+SOURCES += \
+    benchmark_certificatemodel.cpp
+
+OTHER_FILES += \
+    data/bundle.pem